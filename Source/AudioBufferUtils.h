@@ -2,60 +2,148 @@
 
 #include <juce_audio_basics/juce_audio_basics.h>
 
+#include <cstring>
+
 class AudioBufferUtils {
 
   public:
 
     /**
-     * Normalize the buffer
+     * Samples per channel checked with one vectorized min/max scan before
+     * looking at single samples
+     */
+    static constexpr int scanBlockSize = 256;
+
+    /**
+     * Normalize the buffer, silent buffers are left untouched
      *
      * @param buffer
+     * @param target Peak magnitude after normalizing
      */
-    static void normalize (juce::AudioBuffer<float> &buffer) {
+    static void normalize (juce::AudioBuffer<float> &buffer, float target = 1.0f) {
       float magnitude = buffer.getMagnitude(0, buffer.getNumSamples());
-      buffer.applyGain(1 / magnitude);
-    }
 
+      if (magnitude <= 0) {
+        return;
+      }
 
-    static int getFirstLoudSample (juce::AudioBuffer<float> &buffer, float threshold) {
-      int sample = 0;
+      buffer.applyGain(target / magnitude);
+    }
+
+    /**
+     * Find the first sample whose magnitude exceeds the threshold on any channel
+     *
+     * @param buffer
+     * @param threshold
+     * @return The sample index or the number of samples if there is none
+     */
+    static int getFirstLoudSample (const juce::AudioBuffer<float> &buffer, float threshold) {
       int numSamples = buffer.getNumSamples();
-      int numChannels = buffer.getNumChannels();
 
-      while (sample < numSamples) {
-        for (int channel = 0; channel < numChannels; channel++) {
-          if (buffer.getSample(channel, sample) > threshold) {
-            return sample;
+      for (int start = 0; start < numSamples; start += scanBlockSize) {
+        int length = juce::jmin(scanBlockSize, numSamples - start);
+        int firstLoudSample = numSamples;
+
+        for (int channel = 0; channel < buffer.getNumChannels(); channel++) {
+          const float *samples = buffer.getReadPointer(channel, start);
+
+          if (!AudioBufferUtils::exceeds(samples, length, threshold)) {
+            continue;
+          }
+
+          for (int i = 0; i < length && start + i < firstLoudSample; i++) {
+            if (std::abs(samples[i]) > threshold) {
+              firstLoudSample = start + i;
+              break;
+            }
           }
         }
 
-        sample++;
+        if (firstLoudSample < numSamples) {
+          return firstLoudSample;
+        }
       }
 
-      return sample;
+      return numSamples;
     }
 
+    /**
+     * Find the last sample whose magnitude exceeds the threshold on any channel
+     *
+     * @param buffer
+     * @param threshold
+     * @return The sample index or -1 if there is none
+     */
+    static int getLastLoudSample (const juce::AudioBuffer<float> &buffer, float threshold) {
+      for (int end = buffer.getNumSamples(); end > 0; end -= scanBlockSize) {
+        int start = juce::jmax(0, end - scanBlockSize);
+        int lastLoudSample = -1;
+
+        for (int channel = 0; channel < buffer.getNumChannels(); channel++) {
+          const float *samples = buffer.getReadPointer(channel, start);
+
+          if (!AudioBufferUtils::exceeds(samples, end - start, threshold)) {
+            continue;
+          }
+
+          for (int i = end - start - 1; i >= 0 && start + i > lastLoudSample; i--) {
+            if (std::abs(samples[i]) > threshold) {
+              lastLoudSample = start + i;
+              break;
+            }
+          }
+        }
+
+        if (lastLoudSample >= 0) {
+          return lastLoudSample;
+        }
+      }
+
+      return -1;
+    }
+
+    /**
+     * Cut the silence before the first and after the last loud sample, in
+     * place and without reallocating. Silent buffers are left untouched.
+     *
+     * @param buffer
+     * @param threshold
+     */
     static void trim (juce::AudioBuffer<float> &buffer, float threshold = 0.0001) {
-      juce::AudioBuffer<float> copy;
       int numSamples = buffer.getNumSamples();
       int numChannels = buffer.getNumChannels();
 
-      copy.makeCopyOf(buffer);
-      copy.reverse(0, copy.getNumSamples());
-
       int firstLoudSample = AudioBufferUtils::getFirstLoudSample(buffer, threshold);
-      int firstSilentSample = numSamples - AudioBufferUtils::getFirstLoudSample(copy, threshold);
+
+      if (firstLoudSample >= numSamples) {
+        return;
+      }
+
+      int firstSilentSample = AudioBufferUtils::getLastLoudSample(buffer, threshold) + 1;
       int newNumSamples = firstSilentSample - firstLoudSample;
 
 #if DEBUG
       std::cout << "Trim: 0-" << firstLoudSample << " and " << firstSilentSample << "-" << numSamples << std::endl;
 #endif
 
-      copy.setSize(numChannels, newNumSamples);
-      for (int channel = 0; channel < numChannels; channel++) {
-        copy.copyFrom(channel, 0, buffer, channel, firstLoudSample, newNumSamples);
+      if (firstLoudSample > 0) {
+        for (int channel = 0; channel < numChannels; channel++) {
+          std::memmove(
+            buffer.getWritePointer(channel),
+            buffer.getReadPointer(channel, firstLoudSample),
+            static_cast<size_t>(newNumSamples) * sizeof(float)
+          );
+        }
       }
 
-      buffer.makeCopyOf(copy);
+      buffer.setSize(numChannels, newNumSamples, true, false, true);
+    }
+
+  private:
+
+    static bool exceeds (const float *samples, int numSamples, float threshold) {
+      auto range = juce::FloatVectorOperations::findMinAndMax(samples, numSamples);
+
+      return range.getStart() < -threshold || range.getEnd() > threshold;
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <atomic>
+#include <memory>
+
+/**
+ * Hands rendered objects from a producer thread to the audio thread.
+ *
+ * The audio thread only ever swaps pointers, so it never locks, allocates or
+ * frees. Objects it stops using are retired back to the producer side, which
+ * deletes them on its next publish or garbage collection.
+ */
+template<typename T>
+class BufferExchange {
+  public:
+    BufferExchange () = default;
+
+    ~BufferExchange () {
+      delete this->pending.exchange(nullptr);
+      delete this->retired.exchange(nullptr);
+      delete this->current;
+    }
+
+    /**
+     * Producer side: replace the object waiting to be picked up by the audio
+     * thread. An object that was never picked up is deleted right away.
+     *
+     * @param object
+     */
+    void publish (std::unique_ptr<T> object) {
+      delete this->pending.exchange(object.release());
+      this->collectGarbage();
+    }
+
+    /**
+     * Producer side: delete the object the audio thread has stopped using
+     */
+    void collectGarbage () {
+      delete this->retired.exchange(nullptr);
+    }
+
+    /**
+     * Audio side: switch to the most recently published object, if any, and
+     * return the object to read from. The returned pointer is only valid
+     * until the next call.
+     *
+     * @return The current object or nullptr if nothing was published yet
+     */
+    T *acquire () noexcept {
+      // Only swap once the producer has collected the previously retired
+      // object, so the retired slot never holds more than one object
+      if (this->retired.load() == nullptr) {
+        if (T *incoming = this->pending.exchange(nullptr)) {
+          this->retired.store(this->current);
+          this->current = incoming;
+        }
+      }
+
+      return this->current;
+    }
+
+  private:
+    /**
+     * Published by the producer, not yet seen by the audio thread
+     */
+    std::atomic<T *> pending{nullptr};
+
+    /**
+     * Dropped by the audio thread, waiting to be deleted by the producer
+     */
+    std::atomic<T *> retired{nullptr};
+
+    /**
+     * Owned and read by the audio thread only
+     */
+    T *current = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE(BufferExchange)
+};
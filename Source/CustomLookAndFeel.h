@@ -5,9 +5,12 @@
 
 #include <cstdlib>
 #include <cmath>
+#include <functional>
+#include <map>
 
 class CustomLookAndFeel :
-  public juce::LookAndFeel_V4 {
+  public juce::LookAndFeel_V4,
+  private juce::ComponentListener {
   public:
     juce::Colour COLOUR_BLACK;
     juce::Colour COLOUR_WHITE;
@@ -29,10 +32,16 @@ class CustomLookAndFeel :
       DIMENSION_FRACTION = juce::CharPointer_UTF8("%d");
     };
 
+    ~CustomLookAndFeel () override {
+      for (auto &entry: this->decorationCache) {
+        entry.first->removeComponentListener(this);
+      }
+    }
+
     void drawRotarySlider (
       juce::Graphics &g,
       int x,
-      [[maybe_unused]] int y,
+      int y,
       int width,
       int height,
       float sliderPos,
@@ -48,18 +57,110 @@ class CustomLookAndFeel :
       const float rw = radius * 2.0f;
       const float angle = rotaryStartAngle + sliderPos * (rotaryEndAngle - rotaryStartAngle);
 
-      // fill
-      g.setColour(COLOUR_BLACK);
-      g.fillEllipse(rx, ry, rw, rw);
+      const float pointerLength = 18.0f;
+      const float pointerThickness = 5.0f;
 
-      // outline
-      g.setColour(COLOUR_WHITE);
-      g.drawEllipse(rx, ry, rw, rw, 5.0f);
+      juce::uint64 contentHash = hashCombine(0, slider.getName().hashCode64());
+      contentHash = hashCombine(contentHash, slider.getTextValueSuffix().hashCode64());
+      contentHash = hashCombine(contentHash, slider.getMinimum());
+      contentHash = hashCombine(contentHash, slider.getMaximum());
+      contentHash = hashCombine(contentHash, rotaryStartAngle);
+      contentHash = hashCombine(contentHash, rotaryEndAngle);
+      contentHash = hashCombine(contentHash, x);
+      contentHash = hashCombine(contentHash, y);
+
+      // Everything but the pointer stays put while the knob turns
+      this->drawDecorations(
+        g,
+        slider,
+        contentHash,
+        x + width,
+        y + height,
+        [&] (juce::Graphics &decorations) {
+          juce::String suffix = slider.getTextValueSuffix();
+          juce::String labelEnd;
+          juce::String labelStart;
+
+          if (suffix.equalsIgnoreCase(DIMENSION_FRACTION)) {
+            auto min = static_cast<short>(slider.getMinimum());
+            auto max = static_cast<short>(slider.getMaximum());
+            labelStart = "1/" + juce::String(pow(2, abs(min)));
+            labelEnd = juce::String(pow(2, max));
+          } else {
+            labelStart = juce::String((int) slider.getMinimum()) + suffix;
+            if (suffix.equalsIgnoreCase(DIMENSION_HERTZ)) {
+              labelEnd = juce::String((int) (slider.getMaximum() / 1000)) + " kHz";
+            } else if (suffix.equalsIgnoreCase(DIMENSION_MS)) {
+              labelEnd = juce::String((int) (slider.getMaximum() / 1000)) + " s";
+            } else {
+              labelEnd = juce::String((int) slider.getMaximum()) + suffix;
+            }
+          }
+
+          // fill
+          decorations.setColour(COLOUR_BLACK);
+          decorations.fillEllipse(rx, ry, rw, rw);
+
+          // outline
+          decorations.setColour(COLOUR_WHITE);
+          decorations.drawEllipse(rx, ry, rw, rw, 5.0f);
+
+          const int numLines = 10;
+          const float lineThickness = 4.0f;
+          const float lineAngleStep = (rotaryEndAngle - rotaryStartAngle) / numLines;
+          const float lineLength = pointerLength * 0.5f;
+          for (int i = 1; i < numLines; i++) {
+            juce::Path line;
+            const float lineAngle = rotaryStartAngle + (i * lineAngleStep);
+            line.addRectangle(
+              -lineThickness * 0.5f,
+              -radius - lineLength - 6.0f,
+              lineThickness,
+              lineLength
+            );
+            line.applyTransform(
+              juce::AffineTransform::rotation(lineAngle).translated(centreX, centreY));
+
+            // lines
+            decorations.fillPath(line);
+          }
+
+          decorations.setFont(10.0f);
+
+          decorations.drawFittedText(
+            labelStart,
+            0,
+            height - 26,
+            width,
+            12,
+            juce::Justification::left,
+            1
+          );
+          decorations.drawFittedText(
+            labelEnd,
+            0,
+            height - 26,
+            width,
+            12,
+            juce::Justification::right,
+            1
+          );
+
+          decorations.setFont(12.0f);
+          decorations.drawFittedText(
+            slider.getName(),
+            0,
+            height - 12,
+            width,
+            12,
+            juce::Justification::centred,
+            1
+          );
+        }
+      );
 
       // pointer
       juce::Path p;
-      const float pointerLength = 18.0f;
-      const float pointerThickness = 5.0f;
       p.addRectangle(
         -pointerThickness * 0.5f,
         -radius,
@@ -69,79 +170,6 @@ class CustomLookAndFeel :
       p.applyTransform(juce::AffineTransform::rotation(angle).translated(centreX, centreY));
       g.setColour(COLOUR_RED);
       g.fillPath(p);
-
-      g.setColour(COLOUR_WHITE);
-      const int numLines = 10;
-      const float lineThickness = 4.0f;
-      const float lineAngleStep = (rotaryEndAngle - rotaryStartAngle) / numLines;
-      const float lineLength = pointerLength * 0.5f;
-      for (int i = 1; i < numLines; i++) {
-        juce::Path line;
-        const float lineAngle = rotaryStartAngle + (i * lineAngleStep);
-        line.addRectangle(
-          -lineThickness * 0.5f,
-          -radius - lineLength - 6.0f,
-          lineThickness,
-          lineLength
-        );
-        line.applyTransform(
-          juce::AffineTransform::rotation(lineAngle).translated(centreX, centreY));
-
-        // lines
-        g.fillPath(line);
-      }
-
-      g.setFont(10.0f);
-
-      juce::String suffix = slider.getTextValueSuffix();
-      juce::String labelEnd;
-      juce::String labelStart;
-
-      if (suffix.equalsIgnoreCase(DIMENSION_FRACTION)) {
-        auto min = static_cast<short>(slider.getMinimum());
-        auto max = static_cast<short>(slider.getMaximum());
-        labelStart = "1/" + juce::String(pow(2, abs(min)));
-        labelEnd = juce::String(pow(2, max));
-      } else {
-        labelStart = juce::String((int) slider.getMinimum()) + suffix;
-        if (suffix.equalsIgnoreCase(DIMENSION_HERTZ)) {
-          labelEnd = juce::String((int) (slider.getMaximum() / 1000)) + " kHz";
-        } else if (suffix.equalsIgnoreCase(DIMENSION_MS)) {
-          labelEnd = juce::String((int) (slider.getMaximum() / 1000)) + " s";
-        } else {
-          labelEnd = juce::String((int) slider.getMaximum()) + suffix;
-        }
-      }
-
-      g.drawFittedText(
-        labelStart,
-        0,
-        height - 26,
-        width,
-        12,
-        juce::Justification::left,
-        1
-      );
-      g.drawFittedText(
-        labelEnd,
-        0,
-        height - 26,
-        width,
-        12,
-        juce::Justification::right,
-        1
-      );
-
-      g.setFont(12.0f);
-      g.drawFittedText(
-        slider.getName(),
-        0,
-        height - 12,
-        width,
-        12,
-        juce::Justification::centred,
-        1
-      );
     }
 
     void drawComboBox (
@@ -155,26 +183,36 @@ class CustomLookAndFeel :
       [[maybe_unused]] int buttonH,
       juce::ComboBox &box
     ) override {
-      const juce::Rectangle<int> boxBounds(0, 16, width, 32);
-      g.setColour(COLOUR_WHITE);
-      g.fillRect(boxBounds);
-      g.setFont(12.0f);
-      g.drawFittedText(box.getName(), 0, 0, width, 12, juce::Justification::left, 1);
-
-      juce::Rectangle<int> arrowZone(width - 30, 0, 20, height);
-      juce::Path path;
-      path.startNewSubPath(
-        arrowZone.getX() + 3.0f,
-        arrowZone.getCentreY() - 2.0f
-      );
-      path.lineTo(
-        static_cast<float>(arrowZone.getCentreX()),
-        arrowZone.getCentreY() + 3.0f
+      // The selected item is drawn by the box's label, the rest is static
+      this->drawDecorations(
+        g,
+        box,
+        hashCombine(0, box.getName().hashCode64()),
+        width,
+        height,
+        [&] (juce::Graphics &decorations) {
+          const juce::Rectangle<int> boxBounds(0, 16, width, 32);
+          decorations.setColour(COLOUR_WHITE);
+          decorations.fillRect(boxBounds);
+          decorations.setFont(12.0f);
+          decorations.drawFittedText(box.getName(), 0, 0, width, 12, juce::Justification::left, 1);
+
+          juce::Rectangle<int> arrowZone(width - 30, 0, 20, height);
+          juce::Path path;
+          path.startNewSubPath(
+            arrowZone.getX() + 3.0f,
+            arrowZone.getCentreY() - 2.0f
+          );
+          path.lineTo(
+            static_cast<float>(arrowZone.getCentreX()),
+            arrowZone.getCentreY() + 3.0f
+          );
+          path.lineTo(arrowZone.getRight() - 3.0f, arrowZone.getCentreY() - 2.0f);
+
+          decorations.setColour(COLOUR_BLACK);
+          decorations.strokePath(path, juce::PathStrokeType(2.0f));
+        }
       );
-      path.lineTo(arrowZone.getRight() - 3.0f, arrowZone.getCentreY() - 2.0f);
-
-      g.setColour(COLOUR_BLACK);
-      g.strokePath(path, juce::PathStrokeType(2.0f));
 
       box.setColour(juce::ComboBox::textColourId, COLOUR_BLACK);
     }
@@ -354,4 +392,92 @@ class CustomLookAndFeel :
         1
       );
     }
+
+  private:
+    /**
+     * Pre-rendered static parts of a widget, with what they were rendered for
+     */
+    struct Decorations {
+      juce::uint64 contentHash = 0;
+      int width = 0;
+      int height = 0;
+      int scalePercent = 0;
+      juce::Image image;
+    };
+
+    /**
+     * One entry per component, replaced when anything it was rendered for
+     * changes and dropped when the component is deleted
+     */
+    std::map<juce::Component *, Decorations> decorationCache;
+
+    template<typename T>
+    static juce::uint64 hashCombine (juce::uint64 seed, const T &value) {
+      return seed ^ (std::hash<T>{}(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+    }
+
+    void componentBeingDeleted (juce::Component &component) override {
+      this->decorationCache.erase(&component);
+    }
+
+    /**
+     * Draw static decorations from an image rendered the first time they
+     * are needed, at the physical resolution of the display
+     *
+     * @param g
+     * @param component Widget the decorations belong to
+     * @param contentHash Of everything the decorations depend on besides
+     *                    their size
+     * @param width
+     * @param height
+     * @param paintDecorations Draws the decorations into the given context
+     */
+    template<typename Painter>
+    void drawDecorations (
+      juce::Graphics &g,
+      juce::Component &component,
+      juce::uint64 contentHash,
+      int width,
+      int height,
+      Painter &&paintDecorations
+    ) {
+      if (width <= 0 || height <= 0) {
+        return;
+      }
+
+      const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+      const int scalePercent = juce::roundToInt(scale * 100.0f);
+
+      auto [cached, inserted] = this->decorationCache.try_emplace(&component);
+      Decorations &entry = cached->second;
+
+      if (inserted) {
+        component.addComponentListener(this);
+      }
+
+      if (
+        inserted ||
+        entry.contentHash != contentHash ||
+        entry.width != width ||
+        entry.height != height ||
+        entry.scalePercent != scalePercent
+        ) {
+        entry.contentHash = contentHash;
+        entry.width = width;
+        entry.height = height;
+        entry.scalePercent = scalePercent;
+        entry.image = juce::Image(
+          juce::Image::ARGB,
+          juce::roundToInt((float) width * scale),
+          juce::roundToInt((float) height * scale),
+          true
+        );
+
+        juce::Graphics imageGraphics(entry.image);
+        imageGraphics.addTransform(juce::AffineTransform::scale(scale));
+        paintDecorations(imageGraphics);
+      }
+
+      g.drawImageTransformed(entry.image, juce::AffineTransform::scale(1.0f / scale));
+    }
 };
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <atomic>
+#include <cmath>
+
+/**
+ * How long the audio callback takes against its real-time budget, the
+ * duration of the audio it produces.
+ *
+ * Only the audio thread writes, with plain atomic loads and stores, so the
+ * callback never locks or waits. Any thread reads the figures at any time,
+ * each one is consistent on its own.
+ */
+class DeadlineMonitor {
+  public:
+    /**
+     * Histogram buckets, each bucketWidth of the budget wide. The last one
+     * also takes everything beyond.
+     */
+    static constexpr int numBuckets = 20;
+    static constexpr double bucketWidth = 0.1;
+
+    struct Statistics {
+      juce::uint64 numBlocks = 0;
+      juce::uint64 numOverruns = 0;
+
+      /**
+       * Longest block relative to its budget, above 1 means it overran
+       */
+      double worstLoad = 0;
+      double worstMs = 0;
+
+      std::array<juce::uint64, numBuckets> histogram{};
+
+      /**
+       * @param fraction Of the blocks, e.g. 0.99
+       * @return The load that many blocks stayed at or below, to bucket
+       *         precision
+       */
+      double getLoadPercentile (double fraction) const {
+        if (this->numBlocks == 0) {
+          return 0;
+        }
+
+        auto threshold = (juce::uint64) std::ceil(fraction * (double) this->numBlocks);
+        juce::uint64 count = 0;
+
+        for (int bucket = 0; bucket < numBuckets; bucket++) {
+          count += this->histogram[(size_t) bucket];
+
+          if (count >= threshold) {
+            return (bucket + 1) * bucketWidth;
+          }
+        }
+
+        return this->worstLoad;
+      }
+    };
+
+    /**
+     * Times one callback from its construction to its destruction
+     */
+    class ScopedBlock {
+      public:
+        ScopedBlock (DeadlineMonitor &monitorIn, int numSamplesIn) :
+          monitor(monitorIn),
+          numSamples(numSamplesIn),
+          startTicks(juce::Time::getHighResolutionTicks()) {
+          this->monitor.lastCallbackTicks.store(this->startTicks, std::memory_order_relaxed);
+        }
+
+        ~ScopedBlock () {
+          auto ticks = juce::Time::getHighResolutionTicks() - this->startTicks;
+          this->monitor.addBlock(juce::Time::highResolutionTicksToSeconds(ticks), this->numSamples);
+        }
+
+      private:
+        DeadlineMonitor &monitor;
+        int numSamples;
+        juce::int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedBlock)
+    };
+
+    /**
+     * @param sampleRateIn Sets the budget of a block of a given length
+     */
+    void prepare (double sampleRateIn) {
+      this->sampleRate.store(sampleRateIn, std::memory_order_relaxed);
+    }
+
+    /**
+     * Audio thread: account for one callback
+     *
+     * @param seconds How long it took
+     * @param numSamples How much audio it produced
+     */
+    void addBlock (double seconds, int numSamples) noexcept {
+      double rate = this->sampleRate.load(std::memory_order_relaxed);
+
+      if (rate <= 0 || numSamples <= 0) {
+        return;
+      }
+
+      if (
+        this->resetRequested.load(std::memory_order_relaxed) &&
+        this->resetRequested.exchange(false, std::memory_order_acquire)
+        ) {
+        this->clear();
+      }
+
+      double load = seconds * rate / numSamples;
+      auto bucket = (size_t) juce::jlimit(0, numBuckets - 1, (int) (load / bucketWidth));
+
+      increment(this->histogram[bucket]);
+      increment(this->numBlocks);
+
+      if (load > 1) {
+        increment(this->numOverruns);
+      }
+
+      if (load > this->worstLoad.load(std::memory_order_relaxed)) {
+        this->worstLoad.store(load, std::memory_order_relaxed);
+        this->worstMs.store(seconds * 1000.0, std::memory_order_relaxed);
+      }
+    }
+
+    /**
+     * Start counting afresh from the next callback, from any thread
+     */
+    void reset () {
+      this->resetRequested.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @return Copies of the figures so far
+     */
+    Statistics getStatistics () const {
+      Statistics statistics;
+      statistics.numBlocks = this->numBlocks.load(std::memory_order_relaxed);
+      statistics.numOverruns = this->numOverruns.load(std::memory_order_relaxed);
+      statistics.worstLoad = this->worstLoad.load(std::memory_order_relaxed);
+      statistics.worstMs = this->worstMs.load(std::memory_order_relaxed);
+
+      for (size_t bucket = 0; bucket < (size_t) numBuckets; bucket++) {
+        statistics.histogram[bucket] = this->histogram[bucket].load(std::memory_order_relaxed);
+      }
+
+      return statistics;
+    }
+
+    /**
+     * @return When the last callback started, in high resolution ticks, to
+     *         tell a stalled audio thread from a stopped one
+     */
+    juce::int64 getLastCallbackTicks () const {
+      return this->lastCallbackTicks.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::atomic<double> sampleRate{0};
+    std::atomic<bool> resetRequested{false};
+    std::atomic<juce::int64> lastCallbackTicks{0};
+
+    std::atomic<juce::uint64> numBlocks{0};
+    std::atomic<juce::uint64> numOverruns{0};
+    std::atomic<double> worstLoad{0};
+    std::atomic<double> worstMs{0};
+    std::array<std::atomic<juce::uint64>, numBuckets> histogram{};
+
+    /**
+     * The audio thread is the only writer, so no read-modify-write is needed
+     */
+    static void increment (std::atomic<juce::uint64> &counter) noexcept {
+      counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void clear () noexcept {
+      this->numBlocks.store(0, std::memory_order_relaxed);
+      this->numOverruns.store(0, std::memory_order_relaxed);
+      this->worstLoad.store(0, std::memory_order_relaxed);
+      this->worstMs.store(0, std::memory_order_relaxed);
+
+      for (auto &count: this->histogram) {
+        count.store(0, std::memory_order_relaxed);
+      }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DeadlineMonitor)
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <cmath>
+#include <limits>
+
+class FeedbackDelay {
+
+  public:
+
+    /**
+     * Count the echoes to render: echoes keep coming until the first one
+     * whose peak falls to the threshold or below, which is still rendered
+     *
+     * @param peak Peak magnitude of the dry signal
+     * @param mix Gain of the first echo before feedback
+     * @param feedback Gain applied from one echo to the next
+     * @param threshold
+     */
+    static int getNumEchoes (float peak, float mix, float feedback, float threshold = 0.001f) {
+      float level = peak * mix;
+
+      if (level <= 0 || feedback <= 0) {
+        return 0;
+      }
+
+      feedback = juce::jmin(feedback, 0.999f);
+
+      if (level * feedback <= threshold) {
+        return 1;
+      }
+
+      return static_cast<int>(std::ceil(std::log(threshold / level) / std::log(feedback)));
+    }
+
+    /**
+     * Append feedback echoes to the buffer in a single pass.
+     *
+     * Echo k is the dry signal scaled by mix * feedback^k and delayed by
+     * k * delayTimeInSamples. It is rendered as the recursion
+     * wet[n] = feedback * (mix * dry[n - d] + wet[n - d]), one delay-sized
+     * chunk at a time, so the cost is linear in the output length.
+     *
+     * @param buffer
+     * @param mix
+     * @param feedback
+     * @param delayTimeInSamples
+     * @param threshold
+     */
+    static void render (
+      juce::AudioBuffer<float> &buffer,
+      float mix,
+      float feedback,
+      int delayTimeInSamples,
+      float threshold = 0.001f
+    ) {
+      int numChannels = buffer.getNumChannels();
+      int numSamples = buffer.getNumSamples();
+
+      if (delayTimeInSamples <= 0 || numSamples <= 0) {
+        return;
+      }
+
+      feedback = juce::jmin(feedback, 0.999f);
+
+      int numEchoes = FeedbackDelay::getNumEchoes(buffer.getMagnitude(0, numSamples), mix, feedback, threshold);
+      int maxEchoes = (std::numeric_limits<int>::max() - numSamples) / delayTimeInSamples;
+      numEchoes = juce::jmin(numEchoes, maxEchoes);
+
+      if (numEchoes <= 0) {
+        return;
+      }
+
+      int outputLength = numSamples + numEchoes * delayTimeInSamples;
+      float dryFeedbackGain = feedback * (mix - 1.0f);
+
+      juce::AudioBuffer<float> output(numChannels, outputLength);
+
+      for (int channel = 0; channel < numChannels; channel++) {
+        const float *dry = buffer.getReadPointer(channel);
+        float *out = output.getWritePointer(channel);
+
+        juce::FloatVectorOperations::copy(out, dry, numSamples);
+        juce::FloatVectorOperations::clear(out + numSamples, outputLength - numSamples);
+
+        // With out = dry + wet, the recursion becomes
+        // out[n] = dry[n] + feedback * out[n - d] + feedback * (mix - 1) * dry[n - d]
+        // and every chunk only reads the finished chunk before it
+        for (int start = delayTimeInSamples; start < outputLength; start += delayTimeInSamples) {
+          int length = juce::jmin(delayTimeInSamples, outputLength - start);
+          int dryStart = start - delayTimeInSamples;
+          int dryLength = juce::jlimit(0, length, numSamples - dryStart);
+
+          juce::FloatVectorOperations::addWithMultiply(out + start, out + dryStart, feedback, length);
+
+          if (dryLength > 0) {
+            juce::FloatVectorOperations::addWithMultiply(out + start, dry + dryStart, dryFeedbackGain, dryLength);
+          }
+        }
+      }
+
+      buffer = std::move(output);
+    }
+};
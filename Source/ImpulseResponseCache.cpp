@@ -0,0 +1,31 @@
+#include "BinaryData.h"
+#include "ImpulseResponseCache.h"
+
+void ImpulseResponseCache::getResource (int id, const char *&resourceName, int &resourceSize) {
+  switch (id) {
+    case 5:
+      resourceName = BinaryData::university_of_york_stairwell48khznormtrim_wav;
+      resourceSize = BinaryData::university_of_york_stairwell48khznormtrim_wavSize;
+      break;
+    case 4:
+      resourceName = BinaryData::empty_apartment_bedroom48khznormtrim_wav;
+      resourceSize = BinaryData::empty_apartment_bedroom48khznormtrim_wavSize;
+      break;
+    case 3:
+      resourceName = BinaryData::st_georges48khznormtrim_wav;
+      resourceSize = BinaryData::st_georges48khznormtrim_wavSize;
+      break;
+    case 2:
+      resourceName = BinaryData::nuclear_reactor_hall48khznormtrim_wav;
+      resourceSize = BinaryData::nuclear_reactor_hall48khznormtrim_wavSize;
+      break;
+    case 1:
+      resourceName = BinaryData::york_minster48khznormtrim_wav;
+      resourceSize = BinaryData::york_minster48khznormtrim_wavSize;
+      break;
+    case 0:
+    default:
+      resourceName = BinaryData::warehouse48khznormtrim_wav;
+      resourceSize = BinaryData::warehouse48khznormtrim_wavSize;
+  }
+}
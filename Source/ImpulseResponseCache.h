@@ -0,0 +1,114 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "OfflineConvolution.h"
+
+/**
+ * Decoded and partitioned impulse responses, shared by every plugin instance
+ * in the process through a juce::SharedResourcePointer
+ */
+class ImpulseResponseCache {
+  public:
+    /**
+     * Get the impulse response for the given configuration, decoding and
+     * partitioning it on the first request only. The decoding runs outside
+     * the lock, so other instances keep getting cached entries meanwhile.
+     *
+     * @param id Index of the IMPULSE_RESPONSE choice
+     * @param sampleRate
+     * @param numChannels
+     */
+    std::shared_ptr<const PartitionedImpulseResponse> get (int id, double sampleRate, int numChannels) {
+      {
+        const juce::ScopedLock scope(this->lock);
+
+        if (auto cached = this->find(id, sampleRate, numChannels)) {
+          return cached;
+        }
+      }
+
+      const char *resourceName;
+      int resourceSize;
+      ImpulseResponseCache::getResource(id, resourceName, resourceSize);
+
+      auto impulseResponse = std::make_shared<const PartitionedImpulseResponse>(
+        resourceName,
+        static_cast<size_t>(resourceSize),
+        sampleRate,
+        numChannels
+      );
+
+      const juce::ScopedLock scope(this->lock);
+
+      // Another instance decoded the same one meanwhile, everybody shares
+      // the entry that got in first
+      if (auto cached = this->find(id, sampleRate, numChannels)) {
+        return cached;
+      }
+
+      // Nobody renders at another rate or channel count with these anymore
+      this->entries.erase(
+        std::remove_if(
+          this->entries.begin(),
+          this->entries.end(),
+          [=] (const Entry &entry) {
+            return entry.impulseResponse.use_count() == 1 &&
+                   (!juce::approximatelyEqual(entry.sampleRate, sampleRate) || entry.numChannels != numChannels);
+          }
+        ),
+        this->entries.end()
+      );
+
+      this->entries.push_back({id, sampleRate, numChannels, impulseResponse});
+
+      return impulseResponse;
+    }
+
+    /**
+     * Look up the embedded WAV file of an impulse response
+     *
+     * @param id Index of the IMPULSE_RESPONSE choice
+     * @param resourceName
+     * @param resourceSize
+     */
+    static void getResource (int id, const char *&resourceName, int &resourceSize);
+
+  private:
+    struct Entry {
+      int id;
+      double sampleRate;
+      int numChannels;
+      std::shared_ptr<const PartitionedImpulseResponse> impulseResponse;
+
+      bool matches (int otherId, double otherSampleRate, int otherNumChannels) const {
+        return this->id == otherId &&
+               juce::approximatelyEqual(this->sampleRate, otherSampleRate) &&
+               this->numChannels == otherNumChannels;
+      }
+    };
+
+    /**
+     * Guards the entries only, never held while decoding
+     */
+    juce::CriticalSection lock;
+
+    std::vector<Entry> entries;
+
+    /**
+     * @return The cached entry or nullptr, with the lock held
+     */
+    std::shared_ptr<const PartitionedImpulseResponse> find (int id, double sampleRate, int numChannels) const {
+      for (const auto &entry: this->entries) {
+        if (entry.matches(id, sampleRate, numChannels)) {
+          return entry.impulseResponse;
+        }
+      }
+
+      return nullptr;
+    }
+};
@@ -0,0 +1,219 @@
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_dsp/juce_dsp.h>
+
+#include <cmath>
+
+#include "AudioBufferUtils.h"
+#include "OfflineConvolution.h"
+
+/**
+ * Accumulate the product of two spectra of interleaved complex values
+ *
+ * @param accumulator
+ * @param a
+ * @param b
+ * @param numBins
+ */
+static void multiplyAccumulate (float *accumulator, const float *a, const float *b, int numBins) {
+  for (int i = 0; i < numBins * 2; i += 2) {
+    accumulator[i] += a[i] * b[i] - a[i + 1] * b[i + 1];
+    accumulator[i + 1] += a[i] * b[i + 1] + a[i + 1] * b[i];
+  }
+}
+
+PartitionedImpulseResponse::PartitionedImpulseResponse (
+  const void *sourceData,
+  size_t sourceDataSize,
+  double sampleRate,
+  int numChannelsIn
+) {
+  juce::WavAudioFormat wavFormat;
+  std::unique_ptr<juce::AudioFormatReader> reader(
+    wavFormat.createReaderFor(new juce::MemoryInputStream(sourceData, sourceDataSize, false), true)
+  );
+
+  if (reader == nullptr || sampleRate <= 0 || numChannelsIn <= 0) {
+    return;
+  }
+
+  auto decodedNumSamples = static_cast<int>(reader->lengthInSamples);
+  juce::AudioBuffer<float> decoded(static_cast<int>(reader->numChannels), decodedNumSamples);
+  reader->read(&decoded, 0, decodedNumSamples, 0, true, true);
+
+  AudioBufferUtils::trim(decoded);
+
+  if (decoded.getNumSamples() <= 0) {
+    return;
+  }
+
+  // Resample to the host rate
+  double ratio = reader->sampleRate / sampleRate;
+  this->numChannels = juce::jmin(numChannelsIn, decoded.getNumChannels());
+  this->length = static_cast<int>(std::ceil(decoded.getNumSamples() / ratio));
+
+  juce::AudioBuffer<float> resampled(this->numChannels, this->length);
+
+  for (int channel = 0; channel < this->numChannels; channel++) {
+    if (juce::approximatelyEqual(ratio, 1.0)) {
+      resampled.copyFrom(channel, 0, decoded, channel, 0, this->length);
+      continue;
+    }
+
+    juce::LagrangeInterpolator interpolator;
+    interpolator.process(
+      ratio,
+      decoded.getReadPointer(channel),
+      resampled.getWritePointer(channel),
+      this->length,
+      decoded.getNumSamples(),
+      0
+    );
+  }
+
+  // Normalize the energy the same way juce::dsp::Convolution does
+  float maxSumSquared = 0;
+  for (int channel = 0; channel < this->numChannels; channel++) {
+    const float *samples = resampled.getReadPointer(channel);
+    float sumSquared = 0;
+
+    for (int i = 0; i < this->length; i++) {
+      sumSquared += samples[i] * samples[i];
+    }
+
+    maxSumSquared = juce::jmax(maxSumSquared, sumSquared);
+  }
+
+  if (maxSumSquared > 0) {
+    resampled.applyGain(0.125f / std::sqrt(maxSumSquared));
+  }
+
+  // Split into zero padded partitions and keep their spectra
+  this->numPartitions = (this->length + partitionSize - 1) / partitionSize;
+  this->spectra.resize(static_cast<size_t>(this->numChannels * this->numPartitions * spectrumSize));
+
+  juce::dsp::FFT fft(fftOrder);
+  juce::HeapBlock<float> scratch(2 * fftSize);
+
+  for (int channel = 0; channel < this->numChannels; channel++) {
+    for (int partition = 0; partition < this->numPartitions; partition++) {
+      int start = partition * partitionSize;
+      int numSamples = juce::jmin(partitionSize, this->length - start);
+
+      juce::FloatVectorOperations::clear(scratch.get(), 2 * fftSize);
+      juce::FloatVectorOperations::copy(scratch.get(), resampled.getReadPointer(channel, start), numSamples);
+
+      fft.performRealOnlyForwardTransform(scratch.get(), true);
+
+      auto index = static_cast<size_t>(channel * this->numPartitions + partition);
+      juce::FloatVectorOperations::copy(this->spectra.data() + index * spectrumSize, scratch.get(), spectrumSize);
+    }
+  }
+}
+
+const float *PartitionedImpulseResponse::getPartition (int channel, int partition) const {
+  auto index = static_cast<size_t>(channel * this->numPartitions + partition);
+
+  return this->spectra.data() + index * spectrumSize;
+}
+
+void OfflineConvolution::setImpulseResponse (std::shared_ptr<const PartitionedImpulseResponse> impulseResponseIn) {
+  this->impulseResponse = std::move(impulseResponseIn);
+}
+
+int OfflineConvolution::getImpulseResponseLength () const {
+  return this->impulseResponse == nullptr ? 0 : this->impulseResponse->getLength();
+}
+
+void OfflineConvolution::process (const juce::AudioBuffer<float> &input, juce::AudioBuffer<float> &output) {
+  using IR = PartitionedImpulseResponse;
+
+  auto ir = this->impulseResponse;
+  int numChannels = input.getNumChannels();
+  int inputLength = input.getNumSamples();
+
+  if (ir == nullptr || ir->getLength() <= 0 || inputLength <= 0) {
+    output.makeCopyOf(input);
+    return;
+  }
+
+  int outputLength = inputLength + ir->getLength() - 1;
+  int numBlocks = (outputLength + IR::partitionSize - 1) / IR::partitionSize;
+  int numTasks = numChannels * numBlocks;
+  int numChunks = juce::jmin(numTasks, (this->workers.getNumThreads() + 1) * 4);
+
+  std::vector<float> inputSpectra(static_cast<size_t>(numTasks) * IR::spectrumSize);
+
+  auto getInputSpectrum = [&] (int channel, int block) {
+    return inputSpectra.data() + static_cast<size_t>(channel * numBlocks + block) * IR::spectrumSize;
+  };
+
+  // Split the blocks of all channels into contiguous chunks, each with its
+  // own FFT and scratch space
+  auto forEachBlock = [&] (const std::function<void (int, int, const juce::dsp::FFT &, float *)> &blockTask) {
+    this->workers.parallelFor(numChunks, [&] (int chunk) {
+      juce::dsp::FFT fft(IR::fftOrder);
+      juce::HeapBlock<float> scratch(2 * IR::fftSize);
+
+      auto first = static_cast<int>(static_cast<juce::int64>(numTasks) * chunk / numChunks);
+      auto last = static_cast<int>(static_cast<juce::int64>(numTasks) * (chunk + 1) / numChunks);
+
+      for (int task = first; task < last; task++) {
+        blockTask(task / numBlocks, task % numBlocks, fft, scratch.get());
+      }
+    });
+  };
+
+  // Input segment j spans the samples [(j - 1) * B, (j + 1) * B)
+  forEachBlock([&] (int channel, int block, const juce::dsp::FFT &fft, float *scratch) {
+    int segmentStart = (block - 1) * IR::partitionSize;
+    int copyStart = juce::jmax(0, segmentStart);
+    int copyEnd = juce::jmin(inputLength, segmentStart + IR::fftSize);
+
+    juce::FloatVectorOperations::clear(scratch, 2 * IR::fftSize);
+
+    if (copyEnd > copyStart) {
+      juce::FloatVectorOperations::copy(
+        scratch + (copyStart - segmentStart),
+        input.getReadPointer(channel, copyStart),
+        copyEnd - copyStart
+      );
+    }
+
+    fft.performRealOnlyForwardTransform(scratch, true);
+    juce::FloatVectorOperations::copy(getInputSpectrum(channel, block), scratch, IR::spectrumSize);
+  });
+
+  output.setSize(numChannels, outputLength, false, false, true);
+  float *const *outputChannels = output.getArrayOfWritePointers();
+
+  // Output block j is the sum over partitions k of segment j - k times
+  // partition k, the second half of its inverse transform is alias free
+  forEachBlock([&] (int channel, int block, const juce::dsp::FFT &fft, float *scratch) {
+    int irChannel = juce::jmin(channel, ir->getNumChannels() - 1);
+    int numPartitions = juce::jmin(ir->getNumPartitions(), block + 1);
+
+    juce::FloatVectorOperations::clear(scratch, 2 * IR::fftSize);
+
+    for (int partition = 0; partition < numPartitions; partition++) {
+      multiplyAccumulate(
+        scratch,
+        getInputSpectrum(channel, block - partition),
+        ir->getPartition(irChannel, partition),
+        IR::numBins
+      );
+    }
+
+    fft.performRealOnlyInverseTransform(scratch);
+
+    int outputStart = block * IR::partitionSize;
+    int numSamples = juce::jmin(IR::partitionSize, outputLength - outputStart);
+
+    juce::FloatVectorOperations::copy(
+      outputChannels[channel] + outputStart,
+      scratch + IR::partitionSize,
+      numSamples
+    );
+  });
+}
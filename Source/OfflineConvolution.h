@@ -0,0 +1,108 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+
+#include <memory>
+#include <vector>
+
+#include "WorkerPool.h"
+
+/**
+ * Impulse response decoded from a WAV file, resampled to the host rate,
+ * normalized and split into uniform partitions kept in the frequency domain
+ */
+class PartitionedImpulseResponse {
+  public:
+    /**
+     * Samples per partition, also the hop size of OfflineConvolution
+     */
+    static constexpr int partitionSize = 8192;
+
+    /**
+     * Partitions are zero padded to twice their size before the FFT
+     */
+    static constexpr int fftOrder = 14;
+    static constexpr int fftSize = 1 << fftOrder;
+
+    /**
+     * Non-negative frequency bins kept per partition
+     */
+    static constexpr int numBins = fftSize / 2 + 1;
+
+    /**
+     * Floats per partition spectrum
+     */
+    static constexpr int spectrumSize = numBins * 2;
+
+    /**
+     * @param sourceData WAV file in memory
+     * @param sourceDataSize
+     * @param sampleRate Rate to resample the impulse response to
+     * @param numChannels Channels of the signal it will be applied to
+     */
+    PartitionedImpulseResponse (
+      const void *sourceData,
+      size_t sourceDataSize,
+      double sampleRate,
+      int numChannels
+    );
+
+    int getLength () const { return this->length; }
+
+    int getNumChannels () const { return this->numChannels; }
+
+    int getNumPartitions () const { return this->numPartitions; }
+
+    /**
+     * Spectrum of one partition as numBins interleaved complex values
+     *
+     * @param channel
+     * @param partition
+     */
+    const float *getPartition (int channel, int partition) const;
+
+  private:
+    int length = 0;
+    int numChannels = 0;
+    int numPartitions = 0;
+
+    std::vector<float> spectra;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PartitionedImpulseResponse)
+};
+
+/**
+ * Convolves whole buffers of known length with a partitioned impulse
+ * response, using uniformly partitioned overlap-save.
+ *
+ * Every input segment and every output block is independent of the others,
+ * so both passes are spread over all cores.
+ */
+class OfflineConvolution {
+  public:
+    OfflineConvolution () = default;
+
+    void setImpulseResponse (std::shared_ptr<const PartitionedImpulseResponse> impulseResponseIn);
+
+    /**
+     * @return The length of the current impulse response, 0 if there is none
+     */
+    int getImpulseResponseLength () const;
+
+    /**
+     * Write the full convolution of the input to the output, which is
+     * resized to the input length plus the impulse response length minus one
+     *
+     * @param input
+     * @param output
+     */
+    void process (const juce::AudioBuffer<float> &input, juce::AudioBuffer<float> &output);
+
+  private:
+    std::shared_ptr<const PartitionedImpulseResponse> impulseResponse;
+
+    WorkerPool workers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OfflineConvolution)
+};
@@ -0,0 +1,156 @@
+#include "PeakPyramid.h"
+
+#include <limits>
+
+PeakPyramid::PeakPyramid (int numChannelsIn, int numSamplesIn, double sampleRateIn) :
+  numChannels(juce::jmax(0, numChannelsIn)),
+  numSamples(juce::jmax(0, numSamplesIn)),
+  sampleRate(sampleRateIn) {
+  Level base;
+  base.samplesPerEntry = baseBlockSize;
+  base.numEntries = (this->numSamples + baseBlockSize - 1) / baseBlockSize;
+  base.minima.assign((size_t) (base.numEntries * this->numChannels), std::numeric_limits<float>::max());
+  base.maxima.assign((size_t) (base.numEntries * this->numChannels), std::numeric_limits<float>::lowest());
+
+  this->levels.push_back(std::move(base));
+}
+
+void PeakPyramid::addBlock (const juce::AudioBuffer<float> &block, int numSamplesIn) {
+  Level &base = this->levels[0];
+  int channels = juce::jmin(this->numChannels, block.getNumChannels());
+
+  for (int offset = 0; offset < numSamplesIn && this->nextEntry < base.numEntries;) {
+    int length = juce::jmin(baseBlockSize - this->pendingNumSamples, numSamplesIn - offset);
+
+    for (int channel = 0; channel < channels; channel++) {
+      auto index = (size_t) (channel * base.numEntries + this->nextEntry);
+      auto range = juce::FloatVectorOperations::findMinAndMax(block.getReadPointer(channel, offset), length);
+
+      base.minima[index] = juce::jmin(base.minima[index], range.getStart());
+      base.maxima[index] = juce::jmax(base.maxima[index], range.getEnd());
+    }
+
+    this->pendingNumSamples += length;
+    offset += length;
+
+    if (this->pendingNumSamples == baseBlockSize) {
+      this->flushPendingEntry();
+    }
+  }
+}
+
+void PeakPyramid::flushPendingEntry () {
+  this->nextEntry++;
+  this->pendingNumSamples = 0;
+}
+
+void PeakPyramid::finish () {
+  if (this->pendingNumSamples > 0) {
+    this->flushPendingEntry();
+  }
+
+  this->levels.resize(1);
+
+  while (this->levels.back().numEntries > 1) {
+    const Level &finer = this->levels.back();
+    Level coarser;
+    coarser.samplesPerEntry = finer.samplesPerEntry * levelFactor;
+    coarser.numEntries = (finer.numEntries + levelFactor - 1) / levelFactor;
+    coarser.minima.resize((size_t) (coarser.numEntries * this->numChannels));
+    coarser.maxima.resize((size_t) (coarser.numEntries * this->numChannels));
+
+    for (int channel = 0; channel < this->numChannels; channel++) {
+      const float *finerMinima = finer.minima.data() + channel * finer.numEntries;
+      const float *finerMaxima = finer.maxima.data() + channel * finer.numEntries;
+
+      for (int entry = 0; entry < coarser.numEntries; entry++) {
+        int first = entry * levelFactor;
+        int count = juce::jmin(levelFactor, finer.numEntries - first);
+        auto index = (size_t) (channel * coarser.numEntries + entry);
+
+        coarser.minima[index] = juce::FloatVectorOperations::findMinimum(finerMinima + first, count);
+        coarser.maxima[index] = juce::FloatVectorOperations::findMaximum(finerMaxima + first, count);
+      }
+    }
+
+    // Moved in after reading finer, which push_back may invalidate
+    this->levels.push_back(std::move(coarser));
+  }
+}
+
+juce::Range<float> PeakPyramid::getRange (int channel, int startSample, int endSample) const {
+  startSample = juce::jlimit(0, this->numSamples, startSample);
+  endSample = juce::jlimit(startSample, this->numSamples, endSample);
+
+  if (channel < 0 || channel >= this->numChannels || startSample == endSample) {
+    return {};
+  }
+
+  // The coarsest level whose entries still fit in the span keeps the number
+  // of entries read below levelFactor plus the two partial ones
+  size_t levelIndex = 0;
+  while (
+    levelIndex + 1 < this->levels.size() &&
+    this->levels[levelIndex + 1].samplesPerEntry <= endSample - startSample
+    ) {
+    levelIndex++;
+  }
+
+  const Level &level = this->levels[levelIndex];
+  int first = startSample / level.samplesPerEntry;
+  int last = (endSample - 1) / level.samplesPerEntry;
+  auto offset = (size_t) (channel * level.numEntries + first);
+
+  return {
+    juce::FloatVectorOperations::findMinimum(level.minima.data() + offset, last - first + 1),
+    juce::FloatVectorOperations::findMaximum(level.maxima.data() + offset, last - first + 1)
+  };
+}
+
+void PeakPyramid::writeTo (juce::OutputStream &stream) const {
+  const Level &base = this->levels[0];
+
+  stream.writeString("RFPK");
+  stream.writeInt(this->numChannels);
+  stream.writeInt(this->numSamples);
+  stream.writeDouble(this->sampleRate);
+
+  for (size_t i = 0; i < base.minima.size(); i++) {
+    stream.writeFloat(base.minima[i]);
+    stream.writeFloat(base.maxima[i]);
+  }
+}
+
+std::unique_ptr<PeakPyramid> PeakPyramid::readFrom (juce::InputStream &stream) {
+  if (stream.readString() != "RFPK") {
+    return nullptr;
+  }
+
+  int channels = stream.readInt();
+  int samples = stream.readInt();
+  double rate = stream.readDouble();
+
+  if (channels < 0 || samples < 0) {
+    return nullptr;
+  }
+
+  auto numValues = (juce::int64) channels * (((juce::int64) samples + baseBlockSize - 1) / baseBlockSize) * 2;
+  auto remaining = stream.getNumBytesRemaining();
+
+  if (remaining >= 0 && remaining < numValues * (juce::int64) sizeof(float)) {
+    return nullptr;
+  }
+
+  auto pyramid = std::make_unique<PeakPyramid>(channels, samples, rate);
+  Level &base = pyramid->levels[0];
+
+  for (size_t i = 0; i < base.minima.size(); i++) {
+    base.minima[i] = stream.readFloat();
+    base.maxima[i] = stream.readFloat();
+  }
+
+  pyramid->nextEntry = base.numEntries;
+  pyramid->finish();
+
+  return pyramid;
+}
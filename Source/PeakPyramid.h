@@ -0,0 +1,127 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <memory>
+#include <vector>
+
+/**
+ * Minimum and maximum sample values of a signal at several resolutions.
+ *
+ * The finest level holds one range per baseBlockSize samples, every level
+ * above merges levelFactor entries of the one below. The signal is added in
+ * order, a chunk at a time, while it is produced.
+ */
+class PeakPyramid {
+  public:
+    static constexpr int baseBlockSize = 64;
+    static constexpr int levelFactor = 4;
+
+    /**
+     * @param numChannelsIn
+     * @param numSamplesIn Total length of the signal that will be added
+     * @param sampleRateIn
+     */
+    PeakPyramid (int numChannelsIn, int numSamplesIn, double sampleRateIn);
+
+    /**
+     * Add the next samples of the signal
+     *
+     * @param block
+     * @param numSamples Samples from the start of the block
+     */
+    void addBlock (const juce::AudioBuffer<float> &block, int numSamples);
+
+    /**
+     * Build the coarser levels once the whole signal was added
+     */
+    void finish ();
+
+    int getNumChannels () const { return this->numChannels; }
+
+    int getNumSamples () const { return this->numSamples; }
+
+    double getSampleRate () const { return this->sampleRate; }
+
+    int getNumLevels () const { return (int) this->levels.size(); }
+
+    /**
+     * Range of the samples in [startSample, endSample), read from the
+     * coarsest level that still resolves the span. Entries straddling the
+     * span's ends are included, so the range can only be wider than exact.
+     *
+     * @param channel
+     * @param startSample
+     * @param endSample
+     */
+    juce::Range<float> getRange (int channel, int startSample, int endSample) const;
+
+    /**
+     * Write the finest level, the others are rebuilt when reading
+     *
+     * @param stream
+     */
+    void writeTo (juce::OutputStream &stream) const;
+
+    /**
+     * @param stream
+     * @return The pyramid or nullptr if the stream holds none
+     */
+    static std::unique_ptr<PeakPyramid> readFrom (juce::InputStream &stream);
+
+  private:
+    struct Level {
+      int samplesPerEntry;
+      int numEntries;
+
+      /**
+       * numEntries values per channel, one channel after the other
+       */
+      std::vector<float> minima;
+      std::vector<float> maxima;
+    };
+
+    int numChannels;
+    int numSamples;
+    double sampleRate;
+
+    std::vector<Level> levels;
+
+    /**
+     * Finest level entry being filled by addBlock
+     */
+    int nextEntry = 0;
+    int pendingNumSamples = 0;
+
+    void flushPendingEntry ();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PeakPyramid)
+};
+
+/**
+ * Latest peak pyramid, replaced by the render thread and drawn by the
+ * editor, which hears about replacements through change messages
+ */
+class SharedPeakPyramid :
+  public juce::ChangeBroadcaster {
+  public:
+    void set (std::shared_ptr<const PeakPyramid> pyramidIn) {
+      {
+        const juce::ScopedLock scope(this->lock);
+        this->pyramid = std::move(pyramidIn);
+      }
+
+      this->sendChangeMessage();
+    }
+
+    std::shared_ptr<const PeakPyramid> get () const {
+      const juce::ScopedLock scope(this->lock);
+      return this->pyramid;
+    }
+
+  private:
+    juce::CriticalSection lock;
+    std::shared_ptr<const PeakPyramid> pyramid;
+};
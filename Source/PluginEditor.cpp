@@ -63,8 +63,7 @@ PluginEditor::PluginEditor (
   parameters(guiParams),
   thumbnailBounds(16, 536, 656, 144),
   thumbnailComp(
-    this->pluginProcessor.getThumbnail(),
-    this->pluginProcessor.getThumbnailCache(),
+    this->pluginProcessor.getThumbnailPeaks(),
     this->customLookAndFeel
   ),
   positionOverlay(audioProcessor, customLookAndFeel) {
@@ -155,13 +154,33 @@ PluginEditor::PluginEditor (
   );
   this->addAndMakeVisible(&loadFileButton);
 
-  this->pluginProcessor.getThumbnail().addChangeListener(&thumbnailComp);
+  this->loadProgressBar.setPercentageDisplay(false);
+  this->addChildComponent(&loadProgressBar);
+
+  // Polled only while a load runs, one may already be running when the
+  // editor opens
+  if (this->pluginProcessor.getLoadProgress() >= 0) {
+    this->startTimerHz(10);
+  }
+
   this->formatManager.addDefaultFormats();
 
+  // The waveform is only redrawn when the peaks change, the playhead
+  // moving over it is composited from the buffered image
+  this->thumbnailComp.setOpaque(true);
+  this->thumbnailComp.setBufferedToImage(true);
   this->addAndMakeVisible(&thumbnailComp);
   this->addAndMakeVisible(&positionOverlay);
 
   this->setLookAndFeel(&customLookAndFeel);
+  this->background = juce::ImageCache::getFromMemory(
+    BinaryData::background_png,
+    BinaryData::background_pngSize
+  );
+
+  // Nothing behind the editor needs painting, the background covers it
+  this->setOpaque(true);
+
   this->setSize(688, 704);
 }
 
@@ -171,11 +190,7 @@ PluginEditor::~PluginEditor () {
 }
 
 void PluginEditor::paint (juce::Graphics &g) {
-  juce::Image background = juce::ImageCache::getFromMemory(
-    BinaryData::background_png,
-    BinaryData::background_pngSize
-  );
-  g.drawImageAt(background, 0, 0);
+  g.drawImageAt(this->background, 0, 0);
 }
 
 void PluginEditor::resized () {
@@ -206,9 +221,10 @@ void PluginEditor::resized () {
   this->fallDelayToggleButton->setBounds(368, 384, toggleButtonWidth, toggleButtonHeight);
 
   this->loadFileButton.setBounds(32, 464, 188, 32);
+  this->loadProgressBar.setBounds(32, 500, 188, 8);
 
   this->thumbnailComp.setBounds(this->thumbnailBounds);
-  this->positionOverlay.setBounds(this->thumbnailBounds.expanded(16, 16));
+  this->positionOverlay.setBounds(this->thumbnailBounds.expanded(SimplePositionOverlay::inset));
 }
 
 void PluginEditor::loadFileButtonCLicked () {
@@ -230,11 +246,29 @@ void PluginEditor::loadFileButtonCLicked () {
     juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
     [this] (const juce::FileChooser &chooserReference) {
       juce::File file(chooserReference.getResult());
-      this->pluginProcessor.loadSampleFromFile(file);
+
+      if (file.existsAsFile()) {
+        this->pluginProcessor.requestSampleLoad(file);
+        this->startTimerHz(10);
+      }
     }
   );
 }
 
+void PluginEditor::timerCallback () {
+  double progress = this->pluginProcessor.getLoadProgress();
+
+  if (progress >= 0) {
+    this->loadProgress = progress;
+  }
+
+  this->loadProgressBar.setVisible(progress >= 0);
+
+  if (progress < 0) {
+    this->stopTimer();
+  }
+}
+
 void PluginEditor::buttonClicked (juce::Button *button) {
   if (button == &this->loadFileButton) {
     this->loadFileButtonCLicked();
@@ -12,7 +12,8 @@
 
 class PluginEditor :
   public juce::AudioProcessorEditor,
-  public juce::Button::Listener {
+  public juce::Button::Listener,
+  private juce::Timer {
   public:
     PluginEditor (PluginProcessor &, GUIParams &);
 
@@ -27,6 +28,11 @@ class PluginEditor :
     GUIParams &parameters;
     CustomLookAndFeel customLookAndFeel;
 
+    /**
+     * Decoded once, it covers the whole editor
+     */
+    juce::Image background;
+
     std::unique_ptr<juce::Slider> timeOffsetSlider{};
     std::unique_ptr<juce::Slider> riseTimeWarpSlider{};
     std::unique_ptr<juce::Slider> fallTimeWarpSlider{};
@@ -48,6 +54,12 @@ class PluginEditor :
     std::unique_ptr<juce::FileChooser> fileChooser{};
 
     juce::TextButton loadFileButton{};
+
+    /**
+     * Progress of the running load, polled from the processor
+     */
+    double loadProgress = 0;
+    juce::ProgressBar loadProgressBar{loadProgress};
     juce::AudioPluginFormatManager formatManager{};
 
     const juce::Rectangle<int> thumbnailBounds{};
@@ -74,5 +86,11 @@ class PluginEditor :
 
     void loadFileButtonCLicked ();
 
+    /**
+     * Show the load progress while a load is running, runs from the
+     * request until the load is done
+     */
+    void timerCallback () override;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginEditor)
 };
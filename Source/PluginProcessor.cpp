@@ -4,7 +4,7 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 #include "AudioBufferUtils.h"
-#include "BinaryData.h"
+#include "SampleLoader.h"
 
 PluginProcessor::PluginProcessor () :
   juce::AudioProcessor(
@@ -14,28 +14,41 @@ PluginProcessor::PluginProcessor () :
   sampleRate(-1),
   bpm(120),
   samplesPerBlock(0),
-  position(0),
-  thumbnailCache(5),
-  thumbnail(32, formatManager, thumbnailCache),
   guiParams(*this),
-  processing(false),
   riseProcessor(
     ThreadType::RISE,
     this->riseSampleBuffer,
-    this->guiParams
+    this->guiParams,
+    &this->profiler
   ),
   fallProcessor(
     ThreadType::FALL,
     this->fallSampleBuffer,
-    this->guiParams
+    this->guiParams,
+    &this->profiler
   ),
-  play(false) {
+  transpositions(
+    TranspositionCache::sharedMemoryBudget,
+    [this] () { this->renderThread.notify(); }
+  ),
+  renderThread(
+    [this] () { this->processSample(); },
+    [this] () { this->renderIdle(); }
+  ) {
   this->formatManager.registerBasicFormats();
 
+  this->timeOffsetParameter = this->guiParams.getRawParameterValue(TIME_OFFSET_ID);
+  this->filterTypeParameter = this->guiParams.getRawParameterValue(FILTER_TYPE_ID);
+  this->filterCutoffParameter = this->guiParams.getRawParameterValue(FILTER_CUTOFF_ID);
+  this->filterResonanceParameter = this->guiParams.getRawParameterValue(FILTER_RESONANCE_ID);
+
   this->addListener(this);
 }
 
-PluginProcessor::~PluginProcessor () = default;
+PluginProcessor::~PluginProcessor () {
+  this->removeListener(this);
+  this->renderThread.stopThread(4000);
+}
 
 const juce::String PluginProcessor::getName () const {
   return JucePlugin_Name;
@@ -99,24 +112,35 @@ void PluginProcessor::prepareToPlay (
 ) {
   this->sampleRate = sampleRateIn;
   this->samplesPerBlock = maximumExpectedSamplesPerBlock;
+  this->deadlineMonitor.prepare(sampleRateIn);
 
   juce::AudioPlayHead::CurrentPositionInfo result{};
   juce::AudioPlayHead *const head = this->getPlayHead();
 
   this->bpm = head && head->getPosition() ? result.bpm : 120;
 
-  this->riseProcessor.prepareToPlay(this->sampleRate, this->bpm);
-  this->fallProcessor.prepareToPlay(this->sampleRate, this->bpm);
+  this->filter.reset();
+  this->prepareFilter(sampleRateIn);
+
+  this->voices.prepare(
+    this->getTotalNumOutputChannels(),
+    maximumExpectedSamplesPerBlock,
+    sampleRateIn,
+    PLAY_LOOP
+  );
 
-  if (this->sampleRate > 0) {
-    processSample();
+  if (!this->renderThread.isThreadRunning()) {
+    this->renderThread.startThread();
   }
+
+  this->requestRender();
 }
 
 void PluginProcessor::releaseResources () {
   // When playback stops, you can use this as an opportunity to free up any
   // spare memory, etc.
-  this->position = 0;
+  this->voices.reset();
+  this->playing.store(false);
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -152,61 +176,151 @@ void PluginProcessor::processBlock (
   juce::AudioBuffer<float> &buffer,
   juce::MidiBuffer &midiMessages
 ) {
-  if (!midiMessages.isEmpty()) {
-    for (const juce::MidiMessageMetadata metadata: midiMessages) {
-      auto message = metadata.getMessage();
+  DeadlineMonitor::ScopedBlock deadline(this->deadlineMonitor, buffer.getNumSamples());
+  juce::ScopedNoDenormals noDenormals;
 
-      if (message.isNoteOn(false)) {
-        this->position = 0;
-        this->play = true;
-      }
+  buffer.clear();
 
-      if (message.isNoteOff(true)) {
-        this->play = false;
-        this->position = 0;
-      }
+  const RenderedSample *rendered = this->renderedSample.acquire();
+
+  if (rendered != nullptr && rendered->getNumChannels() <= 0) {
+    rendered = nullptr;
+  }
+
+  // The fall is read at an offset from the rise, so a new time offset
+  // takes effect on the next block without touching the rendered audio
+  int timeOffset = (int) this->timeOffsetParameter->load();
+  int numSamples = buffer.getNumSamples();
+  int spanStart = 0;
+
+  this->transpositions.beginBlock();
+  this->voices.setTransportPlaying(this->isHostPlaying());
+
+  // Play up to every event before applying it, so triggers land on the
+  // exact sample whatever the host block size
+  for (const juce::MidiMessageMetadata metadata: midiMessages) {
+    int eventPosition = juce::jlimit(spanStart, numSamples, metadata.samplePosition);
+
+    this->playSpan(buffer, spanStart, eventPosition - spanStart, rendered, timeOffset);
+    spanStart = eventPosition;
+
+    auto message = metadata.getMessage();
+
+    if (message.isNoteOn(false)) {
+      this->voices.noteOn(message.getNoteNumber(), message.getFloatVelocity());
+    } else if (message.isNoteOff(true)) {
+      this->voices.noteOff(message.getNoteNumber());
+    } else if (message.isAllNotesOff() || message.isAllSoundOff()) {
+      this->voices.allNotesOff();
     }
   }
 
-#if !PLAY_LOOP
-  if (play) {
-#endif
-  buffer.clear();
+  this->playSpan(buffer, spanStart, numSamples - spanStart, rendered, timeOffset);
+
+  this->transpositions.endBlock();
+
+  this->playheadTime.store(juce::Time::getMillisecondCounterHiRes());
+  this->playheadNumSamples.store(numSamples);
+  this->playing.store(rendered != nullptr && this->voices.getNumActiveVoices() > 0);
 
   midiMessages.clear();
 
-  if (this->processedSampleBuffer.getNumChannels() > 0 && !this->processing) {
-    auto bufferSamplesRemaining = this->processedSampleBuffer.getNumSamples() - this->position;
-    int samplesThisTime = juce::jmin(this->samplesPerBlock, bufferSamplesRemaining);
-
-    for (int channel = 0; channel < this->processedSampleBuffer.getNumChannels(); channel++) {
-      buffer.addFrom(
-        channel,
-        0,
-        this->processedSampleBuffer,
-        channel,
-        this->position,
-        samplesThisTime,
-        0.9f
-      );
-
-      this->filters[channel]->processSamples(
-        buffer.getWritePointer(channel),
-        samplesThisTime
-      );
+  if (rendered == nullptr) {
+    return;
+  }
+
+  this->applyFilter(buffer, numSamples);
+}
+
+void PluginProcessor::prepareFilter (double sampleRateIn) {
+  this->filterType = (int) this->filterTypeParameter->load();
+
+  this->cutoffSmoother.reset(sampleRateIn, filterSmoothingSeconds);
+  this->resonanceSmoother.reset(sampleRateIn, filterSmoothingSeconds);
+  this->cutoffSmoother.setCurrentAndTargetValue(this->getFilterCutoff());
+  this->resonanceSmoother.setCurrentAndTargetValue(this->filterResonanceParameter->load());
+
+  float frequency = this->cutoffSmoother.getCurrentValue();
+  float resonance = this->resonanceSmoother.getCurrentValue();
+  StereoBiquad::Coefficients coefficients;
+
+  StereoBiquad::design(this->filterType == 1, sampleRateIn, &frequency, &resonance, 1, &coefficients);
+  this->filter.setCoefficients(coefficients);
+  this->filterJump = false;
+}
+
+float PluginProcessor::getFilterCutoff () const {
+  return juce::jmin(this->filterCutoffParameter->load(), (float) (this->sampleRate.load() * 0.49));
+}
+
+void PluginProcessor::applyFilter (juce::AudioBuffer<float> &buffer, int numSamples) {
+  // The parameters are atomics written by whichever thread the host changes
+  // them on, the coefficients are only ever touched here
+  int type = (int) this->filterTypeParameter->load();
+
+  this->cutoffSmoother.setTargetValue(this->getFilterCutoff());
+  this->resonanceSmoother.setTargetValue(this->filterResonanceParameter->load());
+
+  if (type != this->filterType) {
+    // Ramping from one response to the other would sweep through neither,
+    // switch at once and smooth the cutoff and resonance only
+    this->filterType = type;
+    this->filterJump = true;
+  } else if (
+    !this->filterJump &&
+    !this->cutoffSmoother.isSmoothing() &&
+    !this->resonanceSmoother.isSmoothing()
+    ) {
+    this->filter.process(buffer, 0, numSamples);
+    return;
+  }
+
+  // Coefficients are designed in batches, one set per step, and the filter
+  // ramps between consecutive sets sample by sample
+  float frequencies[maxFilterSteps];
+  float resonances[maxFilterSteps];
+  StereoBiquad::Coefficients coefficients[maxFilterSteps];
+  double currentSampleRate = this->sampleRate.load();
+
+  for (int batchStart = 0; batchStart < numSamples; batchStart += maxFilterSteps * filterStepSize) {
+    int batchLength = juce::jmin(maxFilterSteps * filterStepSize, numSamples - batchStart);
+    int numSteps = (batchLength + filterStepSize - 1) / filterStepSize;
+
+    for (int step = 0; step < numSteps; step++) {
+      int stepLength = juce::jmin(filterStepSize, batchLength - step * filterStepSize);
+
+      frequencies[step] = this->cutoffSmoother.skip(stepLength);
+      resonances[step] = this->resonanceSmoother.skip(stepLength);
     }
 
-    this->position += samplesThisTime;
-    if (this->position >= this->processedSampleBuffer.getNumSamples()) {
-#if !PLAY_LOOP
-      this->play = false;
-#endif
-      this->position = 0;
+    StereoBiquad::design(type == 1, currentSampleRate, frequencies, resonances, numSteps, coefficients);
+
+    for (int step = 0; step < numSteps; step++) {
+      int stepStart = batchStart + step * filterStepSize;
+      int stepLength = juce::jmin(filterStepSize, batchLength - step * filterStepSize);
+
+      if (this->filterJump) {
+        this->filter.setCoefficients(coefficients[step]);
+        this->filterJump = false;
+      }
+
+      this->filter.process(buffer, stepStart, stepLength, coefficients[step]);
     }
   }
-#if !PLAY_LOOP
+}
+
+void PluginProcessor::playSpan (
+  juce::AudioBuffer<float> &buffer,
+  int startSample,
+  int numSamples,
+  const RenderedSample *rendered,
+  int timeOffset
+) {
+  if (rendered == nullptr || numSamples <= 0) {
+    return;
   }
-#endif
+
+  this->voices.render(buffer, startSample, numSamples, *rendered, timeOffset, &this->transpositions);
 }
 
 //==============================================================================
@@ -242,168 +356,274 @@ juce::AudioProcessor *JUCE_CALLTYPE createPluginFilter () {
   return new PluginProcessor();
 }
 
-juce::AudioThumbnail &PluginProcessor::getThumbnail () {
-  return this->thumbnail;
+SharedPeakPyramid &PluginProcessor::getThumbnailPeaks () {
+  return this->thumbnailPeaks;
 }
 
-juce::AudioThumbnailCache &PluginProcessor::getThumbnailCache () {
-  return this->thumbnailCache;
+RenderProfiler &PluginProcessor::getRenderProfiler () {
+  return this->profiler;
 }
 
-void PluginProcessor::concatenate () {
-  // TIME OFFSET
-  auto timeOffset = (float) this->guiParams.getParameterAsValue(TIME_OFFSET_ID).getValue();
-  int offsetNumSamples = (int) ceil((timeOffset / 1000) * this->sampleRate);
-  int numSamples = juce::jmax(
-    1,
-    this->riseSampleBuffer.getNumSamples() + this->fallSampleBuffer.getNumSamples() + offsetNumSamples
-  );
+DeadlineMonitor &PluginProcessor::getDeadlineMonitor () {
+  return this->deadlineMonitor;
+}
+
+void PluginProcessor::updateThumbnail () {
+  const RenderedSample *rendered = this->latestRender;
+
+  if (rendered == nullptr) {
+    return;
+  }
+
+  RenderProfiler::ScopedTimer timer(&this->profiler, "thumbnail");
 
-  this->processedSampleBuffer.setSize(
-    this->originalSampleBuffer.getNumChannels(),
+  int timeOffset = (int) this->timeOffsetParameter->load();
+  int numChannels = rendered->getNumChannels();
+  int numSamples = rendered->getNumSamples(timeOffset);
+
+  auto peaks = std::make_shared<PeakPyramid>(
+    numChannels,
     numSamples,
-    false,
-    true,
-    AVOID_REALLOCATING
+    rendered->getSampleRate()
   );
 
-  int overlapStart = this->riseSampleBuffer.getNumSamples() + offsetNumSamples;
-  int overlapStop = overlapStart + abs(juce::jmin(offsetNumSamples, 0));
-  int overlapLength = overlapStop - overlapStart;
+  // Mixed a chunk at a time, the full mix is never held in memory
+  const int chunkSize = 65536;
+  juce::AudioBuffer<float> chunk(numChannels, juce::jmin(chunkSize, numSamples));
 
-  for (int i = 0; i < processedSampleBuffer.getNumChannels(); i++) {
-    for (int j = 0; j < overlapStart && j < this->riseSampleBuffer.getNumSamples(); j++) {
-      float value = this->riseSampleBuffer.getSample(i, j);
-      this->processedSampleBuffer.setSample(i, j, value);
-    }
+  for (int start = 0; start < numSamples; start += chunkSize) {
+    int length = juce::jmin(chunkSize, numSamples - start);
 
-    for (int j = 0; j < overlapLength; j++) {
-      float value = this->fallSampleBuffer.getSample(i, j) + this->riseSampleBuffer.getSample(i, overlapStart + j);
-      this->processedSampleBuffer.setSample(i, overlapStart + j, value);
-    }
+    chunk.clear();
+    rendered->addTo(chunk, 0, start, length, timeOffset, 1.0f);
 
-    for (int j = 0; j < this->fallSampleBuffer.getNumSamples() - overlapLength; j++) {
-      float value = this->fallSampleBuffer.getSample(i, overlapLength + j);
-      this->processedSampleBuffer.setSample(i, overlapStop + j, value);
-    }
+    peaks->addBlock(chunk, length);
   }
-}
 
-void PluginProcessor::updateThumbnail () {
-  int numChannels = this->processedSampleBuffer.getNumChannels();
-  int numSamples = this->processedSampleBuffer.getNumSamples();
+  peaks->finish();
+  this->thumbnailPeaks.set(std::move(peaks));
 
-  this->thumbnail.reset(
-    numChannels,
-    this->sampleRate,
-    numSamples
-  );
+  this->processedNumSamples.store(numSamples);
+}
 
-  this->thumbnail.addBlock(
-    0,
-    this->processedSampleBuffer,
-    0,
-    numSamples
-  );
+void PluginProcessor::requestRender (bool renderStages) {
+  if (renderStages) {
+    this->renderStagesRequested.store(true);
+  }
+
+  this->renderThread.requestRender();
 }
 
 void PluginProcessor::processSample () {
-  if (this->processing) {
-    return;
-  }
+  this->profiler.beginProfile();
 
-  if (this->originalSampleBuffer.getNumChannels() <= 0) {
-    return;
+  bool loaded = this->loadRequestedSample();
+
+  if (this->renderStagesRequested.exchange(false)) {
+    auto rendered = this->renderSample();
+
+    if (rendered != nullptr) {
+      this->transpositions.invalidate();
+      this->latestRender = rendered.get();
+      this->renderedSample.publish(std::move(rendered));
+    }
   }
 
-  if (this->sampleRate <= 0) {
-    return;
+  // The load only counts as done once its render is playing
+  if (loaded) {
+    this->loadProgress.store(-1);
   }
 
-  this->processing = true;
+  this->updateThumbnail();
+}
 
-#if DEBUG
-  const clock_t start = clock();
-#endif
+bool PluginProcessor::loadRequestedSample () {
+  juce::File file;
+  juce::uint32 generation;
 
-  this->processedSampleBuffer.makeCopyOf(this->originalSampleBuffer);
+  {
+    const juce::ScopedLock loadScope(this->loadLock);
 
-  this->riseSampleBuffer.makeCopyOf(this->originalSampleBuffer);
-  this->fallSampleBuffer.makeCopyOf(this->originalSampleBuffer);
+    if (!this->loadPending) {
+      return false;
+    }
 
-  this->riseProcessor.prepareToPlay(this->sampleRate, this->bpm);
-  this->fallProcessor.prepareToPlay(this->sampleRate, this->bpm);
+    file = this->pendingFile;
+    generation = this->loadGeneration.load();
+    this->loadPending = false;
+  }
 
-  this->riseProcessor.process();
-  this->fallProcessor.process();
+  this->loadProgress.store(0);
 
-  AudioBufferUtils::trim(this->riseSampleBuffer);
-  AudioBufferUtils::trim(this->fallSampleBuffer);
+  // A newer request bumps the generation, which stops this read at the
+  // next chunk. The newer one is still pending and runs next.
+  juce::AudioBuffer<float> sample;
+  juce::String error;
 
-  AudioBufferUtils::normalize(this->riseSampleBuffer);
-  AudioBufferUtils::normalize(this->fallSampleBuffer);
+  {
+    RenderProfiler::ScopedTimer timer(&this->profiler, "load");
 
-  concatenate();
+    error = SampleLoader::load(
+      this->formatManager,
+      file,
+      sample,
+      [this, generation] (double progress) {
+        this->loadProgress.store(progress * 0.7);
 
-  AudioBufferUtils::normalize(this->processedSampleBuffer);
+        return this->loadGeneration.load() == generation && !this->renderThread.threadShouldExit();
+      }
+    );
+  }
 
-  int numSamples = this->processedSampleBuffer.getNumSamples();
-  int fades = (int) (numSamples * 0.1);
-  this->processedSampleBuffer.applyGainRamp(0, fades, 0, 1);
-  this->processedSampleBuffer.applyGainRamp(
-    numSamples - fades,
-    fades,
-    1,
-    0
-  );
+  if (error == SampleLoader::cancelled) {
+    return false;
+  }
 
-  this->position = 0;
+  if (error.isNotEmpty()) {
+    std::cout << error << std::endl;
+    this->loadProgress.store(-1);
+    return false;
+  }
 
-#if DEBUG
-  std::cout << "Processed: " << float((clock() - start)) / CLOCKS_PER_SEC << " s, "
-            << this->processedSampleBuffer.getNumChannels() << " Channels, "
-            << this->processedSampleBuffer.getNumSamples() << " Samples" << std::endl;
-#endif
+  this->newSampleLoaded(sample);
+  this->loadProgress.store(0.7);
 
-  this->processing = false;
-  updateThumbnail();
+  return true;
 }
 
-void PluginProcessor::newSampleLoaded () {
-  this->filters.clear();
-  for (int i = 0; i < this->originalSampleBuffer.getNumChannels(); i++) {
-    this->filters.add(new juce::IIRFilter());
+void PluginProcessor::requestSampleLoad (const juce::File &file) {
+  {
+    const juce::ScopedLock loadScope(this->loadLock);
+
+    this->filePath = file.getFullPathName();
+    this->pendingFile = file;
+    this->loadPending = true;
+    this->loadGeneration++;
   }
 
-  AudioBufferUtils::normalize(this->originalSampleBuffer);
-  AudioBufferUtils::trim(this->originalSampleBuffer);
+  this->loadProgress.store(0);
+  this->renderThread.requestRender();
+}
 
-  this->processSample();
+double PluginProcessor::getLoadProgress () const {
+  return this->loadProgress.load();
 }
 
-void PluginProcessor::loadSampleFromFile (juce::File &file) {
-  this->filePath = file.getFullPathName();
-  auto reader = this->formatManager.createReaderFor(file);
+bool PluginProcessor::renderIdle () {
+  this->renderedSample.collectGarbage();
 
-  if (reader == nullptr) {
-    std::cout << "FILE DOES NOT EXIST" << std::endl;
-    return;
+  return this->latestRender != nullptr && this->transpositions.buildNext(*this->latestRender);
+}
+
+std::unique_ptr<RenderedSample> PluginProcessor::renderSample () {
+  const juce::ScopedLock renderScope(this->renderLock);
+  const double currentSampleRate = this->sampleRate.load();
+
+  if (currentSampleRate <= 0) {
+    return nullptr;
+  }
+
+  RenderProfiler::ScopedTimer renderTimer(&this->profiler, "render");
+
+  juce::uint64 sourceKey = 0;
+
+  {
+    const juce::ScopedLock sourceScope(this->sourceLock);
+
+    if (this->originalSampleBuffer.getNumChannels() <= 0) {
+      return nullptr;
+    }
+
+    this->riseSampleBuffer.makeCopyOf(this->originalSampleBuffer);
+    this->fallSampleBuffer.makeCopyOf(this->originalSampleBuffer);
+    sourceKey = this->sourceGeneration;
+  }
+
+  {
+    RenderProfiler::ScopedTimer timer(&this->profiler, "prepare");
+
+    this->riseProcessor.prepareToPlay(currentSampleRate, this->bpm.load());
+    this->fallProcessor.prepareToPlay(currentSampleRate, this->bpm.load());
+
+    this->riseProcessor.prepareReverb(this->impulseResponseId.load());
+    this->fallProcessor.prepareReverb(this->impulseResponseId.load());
   }
 
-  auto length = static_cast<int>(reader->lengthInSamples);
+  // The chains share nothing but the read-only parameters
+  this->workers.parallelFor(2, [this, sourceKey] (int index) {
+    SubProcessor &subProcessor = index == RISE ? this->riseProcessor : this->fallProcessor;
+    juce::AudioBuffer<float> &subBuffer = index == RISE ? this->riseSampleBuffer : this->fallSampleBuffer;
 
-  this->originalSampleBuffer.setSize(static_cast<int>(reader->numChannels), length);
+    subProcessor.process(sourceKey);
 
-  reader->read(
-    &this->originalSampleBuffer,
-    0,
-    length,
-    0,
-    true,
-    true
+    {
+      RenderProfiler::ScopedTimer timer(&this->profiler, index == RISE ? "rise trim" : "fall trim");
+      AudioBufferUtils::trim(subBuffer);
+    }
+
+    {
+      RenderProfiler::ScopedTimer timer(&this->profiler, index == RISE ? "rise normalize" : "fall normalize");
+      AudioBufferUtils::normalize(subBuffer);
+    }
+  });
+
+  // The concatenation and the fades happen while mixing at playback, all
+  // that is left of them here is the overlap peak table
+  RenderProfiler::ScopedTimer mixTimer(&this->profiler, "mix setup");
+
+  // The work buffers are refilled from the original on every render, so
+  // their contents move into the result instead of being copied
+  return std::make_unique<RenderedSample>(
+    std::move(this->riseSampleBuffer),
+    std::move(this->fallSampleBuffer),
+    currentSampleRate
   );
+}
+
+void PluginProcessor::newSampleLoaded (juce::AudioBuffer<float> &sample) {
+  const bool onRenderThread = this->renderThread.isThisTheCurrentThread();
+
+  // Records are filed under the render thread's current profile, so loads
+  // called from any other thread are left out rather than misattributed
+  RenderProfiler *stageProfiler = onRenderThread ? &this->profiler : nullptr;
+
+  {
+    RenderProfiler::ScopedTimer timer(stageProfiler, "normalize");
+    AudioBufferUtils::normalize(sample);
+  }
 
-  this->newSampleLoaded();
+  {
+    RenderProfiler::ScopedTimer timer(stageProfiler, "trim");
+    AudioBufferUtils::trim(sample);
+  }
+
+  {
+    const juce::ScopedLock sourceScope(this->sourceLock);
+    std::swap(this->originalSampleBuffer, sample);
+    this->sourceGeneration++;
+  }
+
+  // The render thread pass that loaded the sample renders it right after,
+  // another request would only run a second pass with nothing to render
+  if (onRenderThread) {
+    this->renderStagesRequested.store(true);
+  } else {
+    this->requestRender();
+  }
+}
+
+void PluginProcessor::loadSampleFromFile (juce::File &file) {
+  this->filePath = file.getFullPathName();
+
+  juce::AudioBuffer<float> sample;
+  juce::String error = SampleLoader::load(this->formatManager, file, sample);
+
+  if (error.isNotEmpty()) {
+    std::cout << error << std::endl;
+    return;
+  }
+
+  this->newSampleLoaded(sample);
 }
 
 void PluginProcessor::audioProcessorParameterChanged (
@@ -411,38 +631,7 @@ void PluginProcessor::audioProcessorParameterChanged (
   int parameterIndex,
   [[maybe_unused]] float newValue
 ) {
-  if (this->sampleRate <= 0) {
-    return;
-  }
-
-  if (
-    parameterIndex == FILTER_RESONANCE ||
-    parameterIndex == FILTER_CUTOFF ||
-    parameterIndex == FILTER_TYPE
-    ) {
-    auto resonanceParam = (juce::AudioParameterFloat *) this->guiParams.getParameter(FILTER_RESONANCE_ID);
-    auto cutoffParam = (juce::AudioParameterInt *) this->guiParams.getParameter(FILTER_CUTOFF_ID);
-    auto typeParam = (juce::AudioParameterChoice *) this->guiParams.getParameter(FILTER_TYPE_ID);
-
-    int filterType = typeParam->getIndex();
-    int cutoff = cutoffParam->get();
-    float resonance = resonanceParam->get();
-
-    switch (filterType) {
-      case 1:
-        this->iirCoefficients = juce::IIRCoefficients::makeLowPass(this->sampleRate, cutoff, resonance);
-        break;
-      case 2:
-        this->iirCoefficients = juce::IIRCoefficients::makeHighPass(this->sampleRate, cutoff, resonance);
-        break;
-      default:
-        break;
-    }
-
-    for (int i = 0; i < this->processedSampleBuffer.getNumChannels(); i++) {
-      this->filters[i]->setCoefficients(this->iirCoefficients);
-    }
-
+  if (this->sampleRate.load() <= 0) {
     return;
   }
 
@@ -465,58 +654,55 @@ void PluginProcessor::audioProcessorParameterChangeGestureEnd (juce::AudioProces
   }
 
   if (parameterIndex == TIME_OFFSET) {
-    this->processing = true;
-    this->concatenate();
-    this->position = 0;
-    this->processing = false;
-    this->updateThumbnail();
+    this->requestRender(false);
     return;
   }
 
-  this->processSample();
+  this->requestRender();
+}
+
+int PluginProcessor::getPosition () const { return this->voices.getPosition(); }
+
+bool PluginProcessor::isHostPlaying () {
+  juce::AudioPlayHead *head = this->getPlayHead();
+
+  if (head == nullptr) {
+    return true;
+  }
+
+  auto position = head->getPosition();
+
+  return !position.hasValue() || position->getIsPlaying();
 }
 
-int PluginProcessor::getPosition () const { return this->position; }
+double PluginProcessor::getPlayheadPosition () const {
+  if (!this->playing.load()) {
+    return -1;
+  }
+
+  double elapsedMs = juce::Time::getMillisecondCounterHiRes() - this->playheadTime.load();
+
+  if (elapsedMs > playheadTimeoutMs) {
+    return -1;
+  }
+
+  // Never further ahead than one block, the next one restamps the position
+  double ahead = juce::jlimit(
+    0.0,
+    (double) this->playheadNumSamples.load(),
+    elapsedMs * 0.001 * this->sampleRate.load()
+  );
+
+  return juce::jmin((double) this->getPosition() + ahead, (double) this->processedNumSamples.load());
+}
 
 int PluginProcessor::getNumSamples () {
-  return this->processedSampleBuffer.getNumSamples();
+  return this->processedNumSamples.load();
 }
 
 void PluginProcessor::loadNewImpulseResponse (int id) {
-  const char *resourceName;
-  int resourceSize;
-
-  switch (id) {
-    case 5:
-      resourceName = BinaryData::university_of_york_stairwell48khznormtrim_wav;
-      resourceSize = BinaryData::university_of_york_stairwell48khznormtrim_wavSize;
-      break;
-    case 4:
-      resourceName = BinaryData::empty_apartment_bedroom48khznormtrim_wav;
-      resourceSize = BinaryData::empty_apartment_bedroom48khznormtrim_wavSize;
-      break;
-    case 3:
-      resourceName = BinaryData::st_georges48khznormtrim_wav;
-      resourceSize = BinaryData::st_georges48khznormtrim_wavSize;
-      break;
-    case 2:
-      resourceName = BinaryData::nuclear_reactor_hall48khznormtrim_wav;
-      resourceSize = BinaryData::nuclear_reactor_hall48khznormtrim_wavSize;
-      break;
-    case 1:
-      resourceName = BinaryData::york_minster48khznormtrim_wav;
-      resourceSize = BinaryData::york_minster48khznormtrim_wavSize;
-      break;
-    case 0:
-    default:
-      resourceName = BinaryData::warehouse48khznormtrim_wav;
-      resourceSize = BinaryData::warehouse48khznormtrim_wavSize;
-  }
-
-  this->riseProcessor.prepareReverb(resourceName, static_cast<size_t>(resourceSize));
-  this->fallProcessor.prepareReverb(resourceName, static_cast<size_t>(resourceSize));
-
-  this->processSample();
+  this->impulseResponseId.store(id);
+  this->requestRender();
 }
 
 void PluginProcessor::audioProcessorChanged (
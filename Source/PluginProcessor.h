@@ -6,8 +6,20 @@
 #include <juce_audio_utils/juce_audio_utils.h>
 #include <juce_audio_formats/juce_audio_formats.h>
 
+#include <atomic>
+
+#include "BufferExchange.h"
+#include "DeadlineMonitor.h"
+#include "PeakPyramid.h"
+#include "RenderedSample.h"
+#include "RenderProfiler.h"
+#include "RenderThread.h"
+#include "StereoBiquad.h"
 #include "SubProcessor.h"
+#include "TranspositionCache.h"
+#include "VoicePool.h"
 #include "GUIParams.h"
+#include "WorkerPool.h"
 
 class PluginProcessor :
   public juce::AudioProcessor,
@@ -56,22 +68,49 @@ class PluginProcessor :
     void setStateInformation (const void *data, int sizeInBytes) override;
 
     /**
-     * Get the thumbnail
+     * Get the waveform peaks of the latest render, for the thumbnail
      *
-     * @return A reference to the thumbnail
+     * @return A reference to the shared peaks
      */
-    juce::AudioThumbnail &getThumbnail ();
+    SharedPeakPyramid &getThumbnailPeaks ();
 
-    juce::AudioThumbnailCache &getThumbnailCache ();
+    /**
+     * Durations of the render stages, one profile per load or render. Read
+     * the last profiles with getEvents or write them out with
+     * exportChromeTrace.
+     *
+     * @return A reference to the profiler
+     */
+    RenderProfiler &getRenderProfiler ();
+
+    /**
+     * Duration of processBlock against its real-time budget, readable from
+     * any thread
+     *
+     * @return A reference to the monitor
+     */
+    DeadlineMonitor &getDeadlineMonitor ();
 
     int getPosition () const;
 
+    /**
+     * Playhead for the editor, moved on from the last block's position by
+     * the time elapsed since that block, so it advances smoothly between
+     * blocks. Safe to call from any thread.
+     *
+     * @return The position in samples, negative while nothing plays
+     */
+    double getPlayheadPosition () const;
+
     int getNumSamples ();
 
     /**
-     * Reset the position and set the new number of samples and channels
+     * Normalize and trim a freshly loaded sample, swap it in as the new
+     * original and schedule a render
+     *
+     * @param sample
      */
-    void newSampleLoaded ();
+    void newSampleLoaded (juce::AudioBuffer<float> &sample);
 
     void loadNewImpulseResponse (int id);
 
@@ -83,10 +122,41 @@ class PluginProcessor :
     void loadSampleFromFile (juce::File &file);
 
     /**
-     * Cascade the multiple audio processing algorithms
+     * Load an audio sample from a file and render it on the render thread.
+     * A load still running is cancelled, playback keeps the previous sample
+     * until the new render is published.
+     *
+     * @param file
+     */
+    void requestSampleLoad (const juce::File &file);
+
+    /**
+     * @return The progress of the running load from 0 to 1, negative when
+     *         no load is running
+     */
+    double getLoadProgress () const;
+
+    /**
+     * Schedule a render on the render thread
+     *
+     * @param renderStages Whether the rise and fall chains have to run again,
+     *                     as opposed to only redrawing the thumbnail at the
+     *                     current time offset
+     */
+    void requestRender (bool renderStages = true);
+
+    /**
+     * Render on the calling thread and publish the result to the audio thread
      */
     void processSample ();
 
+    /**
+     * Cascade the multiple audio processing algorithms on the calling thread
+     *
+     * @return The rendered rise and fall or nullptr if there is nothing to render
+     */
+    std::unique_ptr<RenderedSample> renderSample ();
+
   private:
     /**
      * Buffer containing the samples of the original audio file
@@ -94,54 +164,108 @@ class PluginProcessor :
     juce::AudioBuffer<float> originalSampleBuffer;
 
     /**
-     * Buffer containing the final processed output audio
+     * Bumped whenever originalSampleBuffer is replaced, keys the stage caches
      */
-    juce::AudioBuffer<float> processedSampleBuffer;
+    juce::uint64 sourceGeneration = 0;
 
     /**
-     * Buffer containing the final processed output audio
+     * Rendered rise and fall, published by the render thread and mixed by the
+     * audio thread
+     */
+    BufferExchange<RenderedSample> renderedSample;
+
+    /**
+     * Rendered sample published last, only touched by the render thread,
+     * which is also the only one deleting published samples
+     */
+    const RenderedSample *latestRender = nullptr;
+
+    /**
+     * Length of the last published mix at the current time offset, for the
+     * editor
+     */
+    std::atomic<int> processedNumSamples{0};
+
+    /**
+     * Blocks older than this are taken to mean the host stopped processing
+     */
+    static constexpr double playheadTimeoutMs = 200;
+
+    /**
+     * Whether the last block had any voice playing, when it was processed
+     * and how long it was, stamped by the audio thread for
+     * getPlayheadPosition. The automatic loop voice only plays while the
+     * transport rolls, so the editor idles once the sound stops.
+     */
+    std::atomic<bool> playing{false};
+    std::atomic<double> playheadTime{0};
+    std::atomic<int> playheadNumSamples{0};
+
+    /**
+     * Times every processBlock call
+     */
+    DeadlineMonitor deadlineMonitor;
+
+    /**
+     * Time offset parameter in milliseconds, read once per block
+     */
+    std::atomic<float> *timeOffsetParameter = nullptr;
+
+    /**
+     * Work buffer of the rise chain, moved into the rendered sample
      */
     juce::AudioBuffer<float> riseSampleBuffer;
 
     /**
-     * Buffer containing the final processed output audio
+     * Work buffer of the fall chain, moved into the rendered sample
      */
     juce::AudioBuffer<float> fallSampleBuffer;
 
+    /**
+     * Stage durations of the render thread's passes
+     */
+    RenderProfiler profiler;
+
     SubProcessor riseProcessor;
     SubProcessor fallProcessor;
 
+    /**
+     * Runs the rise and fall chains concurrently
+     */
+    WorkerPool workers;
+
     /**
      * Sample rate for the current block
      */
-    double sampleRate;
+    std::atomic<double> sampleRate;
 
-    double bpm{};
+    std::atomic<double> bpm{};
 
     /**
-     * Number of samples in the current block
+     * Largest block size announced by the host
      */
     int samplesPerBlock;
 
     /**
-     * Current position in the processing of sample blocks
+     * Voices playing the rendered sample, all reading the same buffers
      */
-    int position;
+    VoicePool voices;
 
     /**
-     * Handles basic audio formats (wav, aiff)
+     * Pitch shifted copies of the latest render, for voices away from the
+     * root note
      */
-    juce::AudioFormatManager formatManager;
+    TranspositionCache transpositions;
 
     /**
-     * Cache containing thumbnail previews
+     * Handles basic audio formats (wav, aiff)
      */
-    juce::AudioThumbnailCache thumbnailCache;
+    juce::AudioFormatManager formatManager;
 
     /**
-     * Thumbnail of the audio waveform
+     * Waveform peaks of the latest render at the current time offset
      */
-    juce::AudioThumbnail thumbnail;
+    SharedPeakPyramid thumbnailPeaks;
 
     /**
      * Stores all the parameters
@@ -154,33 +278,137 @@ class PluginProcessor :
     juce::String filePath = "";
 
     /**
-     * Block processing of the sample if it is already in process
+     * Guards originalSampleBuffer between the loading and the render thread
+     */
+    juce::CriticalSection sourceLock;
+
+    /**
+     * Serializes renders started by the render thread and direct callers
+     */
+    juce::CriticalSection renderLock;
+
+    /**
+     * Whether the next render has to run the rise and fall chains
+     */
+    std::atomic<bool> renderStagesRequested{true};
+
+    /**
+     * Guards the pending load request
+     */
+    juce::CriticalSection loadLock;
+
+    juce::File pendingFile;
+    bool loadPending = false;
+
+    /**
+     * Bumped by every load request, a running load stops when it changes
+     */
+    std::atomic<juce::uint32> loadGeneration{0};
+
+    std::atomic<double> loadProgress{-1};
+
+    /**
+     * Read the most recently requested file, if any, on the render thread
+     *
+     * @return Whether a new sample was loaded
      */
-    bool processing;
+    bool loadRequestedSample ();
 
     /**
-     * Whether the plugin should start playback or not
+     * Audio thread: whether the host reports its transport as playing.
+     * Hosts without a transport, like the standalone app, always play.
      */
-    bool play{};
+    bool isHostPlaying ();
 
     /**
-     * Array of filters (one for each channel)
+     * Impulse response selected for the next render
      */
-    juce::OwnedArray<juce::IIRFilter> filters;
+    std::atomic<int> impulseResponseId{0};
 
     /**
-     * Infinite Impulse Response Filter Coefficients
+     * Output filter, all channels at once
      */
-    juce::IIRCoefficients iirCoefficients;
+    StereoBiquad filter;
+
+    std::atomic<float> *filterTypeParameter = nullptr;
+    std::atomic<float> *filterCutoffParameter = nullptr;
+    std::atomic<float> *filterResonanceParameter = nullptr;
 
     /**
-     * Clone the processed audio, reverse it and finally prepend it to the
-     * processed audio buffer
+     * Samples per set of filter coefficients while the cutoff or the
+     * resonance move, the filter interpolates in between
      */
-    void concatenate ();
+    static constexpr int filterStepSize = 32;
 
     /**
-     * Update the thumbnail image
+     * Coefficient sets designed in one batch
+     */
+    static constexpr int maxFilterSteps = 64;
+
+    static constexpr double filterSmoothingSeconds = 0.05;
+
+    /**
+     * Filter state of the audio thread
+     */
+    int filterType = 0;
+
+    /**
+     * Set when the coefficients have to jump to the next set instead of
+     * ramping to it
+     */
+    bool filterJump = true;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> cutoffSmoother;
+    juce::SmoothedValue<float> resonanceSmoother;
+
+    /**
+     * Jump the smoothers and the coefficients to the current parameters
+     *
+     * @param sampleRateIn
+     */
+    void prepareFilter (double sampleRateIn);
+
+    /**
+     * @return The cutoff parameter, kept below the Nyquist frequency
+     */
+    float getFilterCutoff () const;
+
+    /**
+     * Filter the block, with the cutoff and the resonance smoothed and the
+     * coefficients interpolated
+     *
+     * @param buffer
+     * @param numSamples
+     */
+    void applyFilter (juce::AudioBuffer<float> &buffer, int numSamples);
+
+    /**
+     * Add every playing voice to a span of the block
+     *
+     * @param buffer
+     * @param startSample
+     * @param numSamples
+     * @param rendered Nothing is played if nullptr
+     * @param timeOffset Time offset parameter value in milliseconds
+     */
+    void playSpan (
+      juce::AudioBuffer<float> &buffer,
+      int startSample,
+      int numSamples,
+      const RenderedSample *rendered,
+      int timeOffset
+    );
+
+    /**
+     * Housekeeping between renders: free what the audio thread dropped and
+     * build the next requested transposition
+     *
+     * @return Whether a transposition was built
+     */
+    bool renderIdle ();
+
+    /**
+     * Update the thumbnail image with the latest render mixed at the current
+     * time offset
      */
     void updateThumbnail ();
 
@@ -213,5 +441,11 @@ class PluginProcessor :
       int parameterIndex
     ) override;
 
+    /**
+     * Runs renders off the message and audio threads, declared last so it
+     * stops before anything it renders with is destroyed
+     */
+    RenderThread renderThread;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginProcessor)
 };
@@ -0,0 +1,107 @@
+#include "RenderProfiler.h"
+
+#include <algorithm>
+
+void RenderProfiler::record (const char *name, double startMs, double endMs) noexcept {
+  juce::uint64 index = this->nextIndex.fetch_add(1, std::memory_order_relaxed);
+  Slot &slot = this->slots[index % capacity];
+
+  // Marked as being written before any field changes
+  slot.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.profile.store(this->currentProfile.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  slot.thread.store(
+    (juce::uint32) reinterpret_cast<juce::pointer_sized_uint>(juce::Thread::getCurrentThreadId()),
+    std::memory_order_relaxed
+  );
+  slot.startMs.store(startMs, std::memory_order_relaxed);
+  slot.endMs.store(endMs, std::memory_order_relaxed);
+
+  slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+std::vector<RenderProfiler::Event> RenderProfiler::getEvents (int numProfiles) const {
+  juce::uint64 end = this->nextIndex.load(std::memory_order_acquire);
+  juce::uint64 begin = end > (juce::uint64) capacity ? end - capacity : 0;
+
+  std::vector<Event> events;
+  events.reserve((size_t) (end - begin));
+
+  for (juce::uint64 index = begin; index < end; index++) {
+    const Slot &slot = this->slots[index % capacity];
+    juce::uint64 sequence = slot.sequence.load(std::memory_order_acquire);
+
+    if (sequence != index + 1) {
+      continue;
+    }
+
+    Event event;
+    event.name = slot.name.load(std::memory_order_relaxed);
+    event.profile = slot.profile.load(std::memory_order_relaxed);
+    event.thread = slot.thread.load(std::memory_order_relaxed);
+    event.startMs = slot.startMs.load(std::memory_order_relaxed);
+    event.endMs = slot.endMs.load(std::memory_order_relaxed);
+
+    // Overwritten while copying
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+      continue;
+    }
+
+    events.push_back(event);
+  }
+
+  // Keep the latest profiles only
+  std::vector<juce::uint64> profiles;
+  for (const Event &event: events) {
+    profiles.push_back(event.profile);
+  }
+  std::sort(profiles.begin(), profiles.end());
+  profiles.erase(std::unique(profiles.begin(), profiles.end()), profiles.end());
+
+  if ((int) profiles.size() > numProfiles) {
+    juce::uint64 oldest = numProfiles > 0 ? profiles[profiles.size() - (size_t) numProfiles] : profiles.back() + 1;
+
+    events.erase(
+      std::remove_if(events.begin(), events.end(), [oldest] (const Event &event) { return event.profile < oldest; }),
+      events.end()
+    );
+  }
+
+  std::sort(events.begin(), events.end(), [] (const Event &a, const Event &b) { return a.startMs < b.startMs; });
+
+  return events;
+}
+
+juce::String RenderProfiler::toChromeTrace (const std::vector<Event> &events) {
+  juce::Array<juce::var> traceEvents;
+
+  for (const Event &event: events) {
+    auto *traceEvent = new juce::DynamicObject();
+    traceEvent->setProperty("name", event.name);
+    traceEvent->setProperty("cat", "render");
+    traceEvent->setProperty("ph", "X");
+    traceEvent->setProperty("ts", event.startMs * 1000.0);
+    traceEvent->setProperty("dur", (event.endMs - event.startMs) * 1000.0);
+    traceEvent->setProperty("pid", 1);
+    traceEvent->setProperty("tid", (juce::int64) event.thread);
+
+    auto *args = new juce::DynamicObject();
+    args->setProperty("profile", (juce::int64) event.profile);
+    traceEvent->setProperty("args", args);
+
+    traceEvents.add(traceEvent);
+  }
+
+  auto *trace = new juce::DynamicObject();
+  trace->setProperty("traceEvents", traceEvents);
+  trace->setProperty("displayTimeUnit", "ms");
+
+  return juce::JSON::toString(juce::var(trace));
+}
+
+bool RenderProfiler::exportChromeTrace (const juce::File &file, int numProfiles) const {
+  return file.replaceWithText(RenderProfiler::toChromeTrace(this->getEvents(numProfiles)));
+}
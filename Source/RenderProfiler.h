@@ -0,0 +1,124 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+/**
+ * Durations of the render stages, kept in release builds.
+ *
+ * Stages record into a fixed ring of slots without locking or allocating,
+ * from whichever thread they run on. Readers copy out what is there and skip
+ * slots being overwritten at the same time. Every record belongs to the
+ * profile started last, one profile per pass of the render thread.
+ */
+class RenderProfiler {
+  public:
+    /**
+     * Records kept, the oldest are overwritten first
+     */
+    static constexpr int capacity = 4096;
+
+    struct Event {
+      /**
+       * Stage name, a string literal
+       */
+      const char *name = nullptr;
+      juce::uint64 profile = 0;
+      juce::uint32 thread = 0;
+      double startMs = 0;
+      double endMs = 0;
+    };
+
+    /**
+     * Records the time from its construction to its destruction. A null
+     * profiler records nothing.
+     */
+    class ScopedTimer {
+      public:
+        ScopedTimer (RenderProfiler *profilerIn, const char *nameIn) :
+          profiler(profilerIn),
+          name(nameIn),
+          startMs(profilerIn != nullptr ? juce::Time::getMillisecondCounterHiRes() : 0) {
+        }
+
+        ~ScopedTimer () {
+          if (this->profiler != nullptr) {
+            this->profiler->record(this->name, this->startMs, juce::Time::getMillisecondCounterHiRes());
+          }
+        }
+
+      private:
+        RenderProfiler *profiler;
+        const char *name;
+        double startMs;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedTimer)
+    };
+
+    /**
+     * Start a new profile, the following records belong to it
+     *
+     * @return Its id
+     */
+    juce::uint64 beginProfile () {
+      return ++this->currentProfile;
+    }
+
+    /**
+     * @param name A string literal, only the pointer is kept
+     * @param startMs
+     * @param endMs
+     */
+    void record (const char *name, double startMs, double endMs) noexcept;
+
+    /**
+     * Copy the records of the latest profiles, oldest first
+     *
+     * @param numProfiles
+     * @return The records by start time
+     */
+    std::vector<Event> getEvents (int numProfiles) const;
+
+    /**
+     * Format records as Chrome trace events, for chrome://tracing or
+     * Perfetto
+     *
+     * @param events
+     * @return The JSON document
+     */
+    static juce::String toChromeTrace (const std::vector<Event> &events);
+
+    /**
+     * @param file
+     * @param numProfiles
+     * @return Whether the file was written
+     */
+    bool exportChromeTrace (const juce::File &file, int numProfiles) const;
+
+  private:
+    /**
+     * Every field is atomic so readers racing a writer see stale or torn
+     * records, which the sequence check throws away, but never undefined
+     * behaviour
+     */
+    struct Slot {
+      /**
+       * Index of the record plus one once written, 0 while being written
+       */
+      std::atomic<juce::uint64> sequence{0};
+      std::atomic<const char *> name{nullptr};
+      std::atomic<juce::uint64> profile{0};
+      std::atomic<juce::uint32> thread{0};
+      std::atomic<double> startMs{0};
+      std::atomic<double> endMs{0};
+    };
+
+    std::array<Slot, capacity> slots;
+    std::atomic<juce::uint64> nextIndex{0};
+    std::atomic<juce::uint64> currentProfile{0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RenderProfiler)
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <atomic>
+#include <functional>
+
+/**
+ * Dedicated worker running sample renders off the message and audio threads
+ */
+class RenderThread :
+  public juce::Thread {
+  public:
+    /**
+     * How often the idle callback runs while nothing wakes the thread. Work
+     * flagged by the audio thread calls notify to start promptly.
+     */
+    static constexpr int idleIntervalMs = 200;
+
+    /**
+     * @param renderCallback Runs a full render, called on this thread
+     * @param idleCallback Housekeeping, called on this thread while idle.
+     *                     Returns whether it did any work, it runs again
+     *                     right away if so.
+     */
+    RenderThread (std::function<void ()> renderCallback, std::function<bool ()> idleCallback) :
+      juce::Thread("Rise & Fall Render"),
+      render(std::move(renderCallback)),
+      idle(std::move(idleCallback)) {
+    }
+
+    ~RenderThread () override {
+      this->stopThread(4000);
+    }
+
+    /**
+     * Ask for a render. Requests arriving while a render is running are
+     * coalesced into a single follow-up render.
+     */
+    void requestRender () {
+      this->renderRequested.store(true);
+      this->notify();
+    }
+
+    void run () override {
+      while (!this->threadShouldExit()) {
+        if (this->renderRequested.exchange(false)) {
+          this->render();
+          continue;
+        }
+
+        if (!this->idle()) {
+          this->wait(idleIntervalMs);
+        }
+      }
+    }
+
+  private:
+    std::function<void ()> render;
+    std::function<bool ()> idle;
+
+    std::atomic<bool> renderRequested{false};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RenderThread)
+};
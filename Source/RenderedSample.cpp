@@ -0,0 +1,181 @@
+#include "RenderedSample.h"
+
+#include <cmath>
+
+RenderedSample::RenderedSample (
+  juce::AudioBuffer<float> &&riseIn,
+  juce::AudioBuffer<float> &&fallIn,
+  double sampleRateIn
+) :
+  rise(std::move(riseIn)),
+  fall(std::move(fallIn)),
+  sampleRate(sampleRateIn),
+  overlapPeaks(static_cast<size_t>(maxOverlapMs + 1), 1.0f) {
+  int riseLength = this->rise.getNumSamples();
+  int fallLength = this->fall.getNumSamples();
+  int numChannels = juce::jmin(this->rise.getNumChannels(), this->fall.getNumChannels());
+
+  std::vector<float> overlap(static_cast<size_t>(juce::jmin(riseLength, fallLength)));
+  int lastFallStart = -1;
+
+  // Only the overlap can push the peak of the mix above one. Offsets that
+  // clamp to the same fall start share the peak of the previous one.
+  for (int ms = 1; ms <= maxOverlapMs; ms++) {
+    int fallStart = this->getFallStart(-ms);
+
+    if (fallStart == lastFallStart) {
+      this->overlapPeaks[(size_t) ms] = this->overlapPeaks[(size_t) ms - 1];
+      continue;
+    }
+
+    lastFallStart = fallStart;
+
+    int overlapLength = juce::jmin(riseLength, fallStart + fallLength) - fallStart;
+    float peak = 1.0f;
+
+    for (int channel = 0; channel < numChannels && overlapLength > 0; channel++) {
+      juce::FloatVectorOperations::add(
+        overlap.data(),
+        this->rise.getReadPointer(channel, fallStart),
+        this->fall.getReadPointer(channel),
+        overlapLength
+      );
+
+      auto range = juce::FloatVectorOperations::findMinAndMax(overlap.data(), overlapLength);
+      peak = juce::jmax(peak, -range.getStart(), range.getEnd());
+    }
+
+    this->overlapPeaks[(size_t) ms] = peak;
+  }
+}
+
+int RenderedSample::getFallStart (int timeOffset) const {
+  int offsetNumSamples = (int) std::ceil((timeOffset / 1000.0) * this->sampleRate);
+
+  return juce::jmax(0, this->rise.getNumSamples() + offsetNumSamples);
+}
+
+int RenderedSample::getNumSamples (int timeOffset) const {
+  return juce::jmax(
+    1,
+    this->rise.getNumSamples(),
+    this->getFallStart(timeOffset) + this->fall.getNumSamples()
+  );
+}
+
+float RenderedSample::getNormalizationGain (int timeOffset) const {
+  int overlapMs = juce::jlimit(0, maxOverlapMs, -timeOffset);
+
+  return 1.0f / this->overlapPeaks[(size_t) overlapMs];
+}
+
+void RenderedSample::addTo (
+  juce::AudioBuffer<float> &destination,
+  int destinationStartSample,
+  int position,
+  int numSamples,
+  int timeOffset,
+  float gain
+) const {
+  int totalNumSamples = this->getNumSamples(timeOffset);
+  int fallStart = this->getFallStart(timeOffset);
+  int fades = (int) (totalNumSamples * 0.1);
+
+  gain *= this->getNormalizationGain(timeOffset);
+
+  // Fade in, sustain and fade out are linear on their own, so the span is
+  // split at their boundaries and every piece gets a single gain ramp
+  auto getFadeGain = [totalNumSamples, fades] (int sample) {
+    if (fades <= 0) {
+      return 1.0f;
+    }
+
+    if (sample < fades) {
+      return (float) sample / (float) fades;
+    }
+
+    return juce::jmin(1.0f, (float) (totalNumSamples - sample) / (float) fades);
+  };
+
+  int end = juce::jmin(position + numSamples, totalNumSamples);
+
+  for (int start = position; start < end;) {
+    int pieceEnd = end;
+
+    if (start < fades) {
+      pieceEnd = juce::jmin(pieceEnd, fades);
+    } else if (start < totalNumSamples - fades) {
+      pieceEnd = juce::jmin(pieceEnd, totalNumSamples - fades);
+    }
+
+    this->addSpan(
+      destination,
+      destinationStartSample + start - position,
+      start,
+      pieceEnd - start,
+      fallStart,
+      gain * getFadeGain(start),
+      gain * getFadeGain(pieceEnd)
+    );
+
+    start = pieceEnd;
+  }
+}
+
+void RenderedSample::mixDown (int timeOffset, juce::AudioBuffer<float> &output) const {
+  int numSamples = this->getNumSamples(timeOffset);
+
+  output.setSize(this->getNumChannels(), numSamples, false, false, true);
+  output.clear();
+
+  this->addTo(output, 0, 0, numSamples, timeOffset, 1.0f);
+}
+
+void RenderedSample::addSpan (
+  juce::AudioBuffer<float> &destination,
+  int destinationStartSample,
+  int position,
+  int numSamples,
+  int fallStart,
+  float startGain,
+  float endGain
+) const {
+  int spanEnd = position + numSamples;
+
+  RenderedSample::addRegion(destination, destinationStartSample, this->rise, 0, position, spanEnd, startGain, endGain);
+  RenderedSample::addRegion(destination, destinationStartSample, this->fall, fallStart, position, spanEnd, startGain, endGain);
+}
+
+void RenderedSample::addRegion (
+  juce::AudioBuffer<float> &destination,
+  int destinationStartSample,
+  const juce::AudioBuffer<float> &source,
+  int regionStart,
+  int spanStart,
+  int spanEnd,
+  float startGain,
+  float endGain
+) {
+  int start = juce::jmax(spanStart, regionStart);
+  int end = juce::jmin(spanEnd, regionStart + source.getNumSamples());
+
+  if (start >= end) {
+    return;
+  }
+
+  float slope = (endGain - startGain) / (float) (spanEnd - spanStart);
+  float regionStartGain = startGain + slope * (float) (start - spanStart);
+  float regionEndGain = startGain + slope * (float) (end - spanStart);
+  int numChannels = juce::jmin(destination.getNumChannels(), source.getNumChannels());
+
+  for (int channel = 0; channel < numChannels; channel++) {
+    destination.addFromWithRamp(
+      channel,
+      destinationStartSample + start - spanStart,
+      source.getReadPointer(channel, start - regionStart),
+      end - start,
+      regionStartGain,
+      regionEndGain
+    );
+  }
+}
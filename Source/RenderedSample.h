@@ -0,0 +1,123 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <vector>
+
+/**
+ * Output of one render: the rise and the fall, kept apart and mixed at
+ * playback time so that the time offset never needs another render.
+ *
+ * The mix is normalized and faded in and out over 10% of its length, like a
+ * single concatenated buffer would be, for any offset in the parameter range.
+ */
+class RenderedSample {
+  public:
+    /**
+     * Largest overlap of the rise and the fall in milliseconds, the lower
+     * bound of the time offset parameter
+     */
+    static constexpr int maxOverlapMs = 1024;
+
+    /**
+     * Both buffers are expected to be normalized and to have the same number
+     * of channels
+     *
+     * @param riseIn
+     * @param fallIn
+     * @param sampleRateIn
+     */
+    RenderedSample (
+      juce::AudioBuffer<float> &&riseIn,
+      juce::AudioBuffer<float> &&fallIn,
+      double sampleRateIn
+    );
+
+    int getNumChannels () const { return this->rise.getNumChannels(); }
+
+    double getSampleRate () const { return this->sampleRate; }
+
+    const juce::AudioBuffer<float> &getRise () const { return this->rise; }
+
+    const juce::AudioBuffer<float> &getFall () const { return this->fall; }
+
+    /**
+     * @param timeOffset Time offset parameter value in milliseconds
+     * @return The length of the mix at that offset
+     */
+    int getNumSamples (int timeOffset) const;
+
+    /**
+     * Add a span of the mix to a buffer, with normalization and fades applied
+     *
+     * @param destination
+     * @param destinationStartSample
+     * @param position First sample of the mix to read
+     * @param numSamples Samples to add, reads past the end of the mix are silent
+     * @param timeOffset Time offset parameter value in milliseconds
+     * @param gain Extra gain applied on top of the normalization
+     */
+    void addTo (
+      juce::AudioBuffer<float> &destination,
+      int destinationStartSample,
+      int position,
+      int numSamples,
+      int timeOffset,
+      float gain
+    ) const;
+
+    /**
+     * Write the whole mix at one offset into a buffer of its own
+     *
+     * @param timeOffset
+     * @param output
+     */
+    void mixDown (int timeOffset, juce::AudioBuffer<float> &output) const;
+
+  private:
+    juce::AudioBuffer<float> rise;
+    juce::AudioBuffer<float> fall;
+
+    double sampleRate;
+
+    /**
+     * Peak of the summed overlap for every whole millisecond of overlap,
+     * never below the unit peak of the rise and the fall on their own
+     */
+    std::vector<float> overlapPeaks;
+
+    int getFallStart (int timeOffset) const;
+
+    float getNormalizationGain (int timeOffset) const;
+
+    /**
+     * Add [position, position + numSamples) of the mix, without fades, with
+     * a gain ramping linearly from startGain to endGain
+     */
+    void addSpan (
+      juce::AudioBuffer<float> &destination,
+      int destinationStartSample,
+      int position,
+      int numSamples,
+      int fallStart,
+      float startGain,
+      float endGain
+    ) const;
+
+    /**
+     * Add the part of a source starting at regionStart in the mix that falls
+     * into [spanStart, spanEnd), ramping the gain across the whole span
+     */
+    static void addRegion (
+      juce::AudioBuffer<float> &destination,
+      int destinationStartSample,
+      const juce::AudioBuffer<float> &source,
+      int regionStart,
+      int spanStart,
+      int spanEnd,
+      float startGain,
+      float endGain
+    );
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RenderedSample)
+};
@@ -0,0 +1,78 @@
+#include "SampleLoader.h"
+
+#include <limits>
+
+const juce::String SampleLoader::cancelled = "Cancelled";
+
+std::unique_ptr<juce::AudioFormatReader> SampleLoader::createReader (
+  juce::AudioFormatManager &formatManager,
+  const juce::File &file
+) {
+  // WAV and AIFF are decoded straight from the mapped file, without the
+  // buffering of a stream
+  for (int i = 0; i < formatManager.getNumKnownFormats(); i++) {
+    juce::AudioFormat *format = formatManager.getKnownFormat(i);
+
+    if (!format->canHandleFile(file)) {
+      continue;
+    }
+
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(format->createMemoryMappedReader(file));
+
+    if (mapped != nullptr && mapped->mapEntireFile()) {
+      return mapped;
+    }
+  }
+
+  return std::unique_ptr<juce::AudioFormatReader>(formatManager.createReaderFor(file));
+}
+
+juce::String SampleLoader::load (
+  juce::AudioFormatManager &formatManager,
+  const juce::File &file,
+  juce::AudioBuffer<float> &sample,
+  const Progress &progress
+) {
+  auto reader = SampleLoader::createReader(formatManager, file);
+
+  if (reader == nullptr) {
+    return "Can't read " + file.getFullPathName();
+  }
+
+  return SampleLoader::read(*reader, sample, progress);
+}
+
+juce::String SampleLoader::read (
+  juce::AudioFormatReader &reader,
+  juce::AudioBuffer<float> &sample,
+  const Progress &progress
+) {
+  const juce::int64 length = reader.lengthInSamples;
+  const int numChannels = static_cast<int>(reader.numChannels);
+
+  // Buffers are indexed with int, longer files are refused rather than
+  // silently truncated
+  if (length <= 0 || numChannels <= 0) {
+    return "The file is empty";
+  }
+
+  if (length > std::numeric_limits<int>::max()) {
+    return "The file is too long, " + juce::String(length) + " samples";
+  }
+
+  sample.setSize(numChannels, static_cast<int>(length), false, false, true);
+
+  for (juce::int64 start = 0; start < length; start += chunkSize) {
+    auto numSamples = static_cast<int>(juce::jmin<juce::int64>(chunkSize, length - start));
+
+    if (!reader.read(&sample, static_cast<int>(start), numSamples, start, true, true)) {
+      return "Failed to decode the file";
+    }
+
+    if (progress != nullptr && !progress((double) (start + numSamples) / (double) length)) {
+      return SampleLoader::cancelled;
+    }
+  }
+
+  return {};
+}
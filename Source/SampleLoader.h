@@ -0,0 +1,72 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+
+#include <functional>
+#include <memory>
+
+/**
+ * Reads audio files into a buffer, memory mapped where the format allows it
+ * and a chunk at a time, so no copy of the whole file is made on the way
+ */
+class SampleLoader {
+  public:
+    /**
+     * Called after every chunk with the fraction read so far, returning
+     * false cancels the read
+     */
+    using Progress = std::function<bool (double)>;
+
+    /**
+     * Samples per channel decoded per read call
+     */
+    static constexpr int chunkSize = 1 << 16;
+
+    /**
+     * Open a reader for the file, preferring a memory mapped one
+     *
+     * @param formatManager
+     * @param file
+     * @return The reader or nullptr if no registered format can read the file
+     */
+    static std::unique_ptr<juce::AudioFormatReader> createReader (
+      juce::AudioFormatManager &formatManager,
+      const juce::File &file
+    );
+
+    /**
+     * Read a file into a buffer sized to fit it
+     *
+     * @param formatManager
+     * @param file
+     * @param sample Only meaningful on success
+     * @param progress Optional
+     * @return An error message, empty on success
+     */
+    static juce::String load (
+      juce::AudioFormatManager &formatManager,
+      const juce::File &file,
+      juce::AudioBuffer<float> &sample,
+      const Progress &progress = nullptr
+    );
+
+    /**
+     * Read every sample of a reader into a buffer, a chunk at a time
+     *
+     * @param reader
+     * @param sample Resized to the reader's channels and length
+     * @param progress Optional
+     * @return An error message, empty on success
+     */
+    static juce::String read (
+      juce::AudioFormatReader &reader,
+      juce::AudioBuffer<float> &sample,
+      const Progress &progress = nullptr
+    );
+
+    /**
+     * Error message of a read cancelled through its progress callback
+     */
+    static const juce::String cancelled;
+};
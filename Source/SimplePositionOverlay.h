@@ -8,10 +8,18 @@ class SimplePositionOverlay :
   public juce::Component,
   private juce::Timer {
   public:
+    /**
+     * Horizontal margin between the overlay's bounds and the waveform it
+     * sits over
+     */
+    static constexpr int inset = 16;
+
     SimplePositionOverlay (PluginProcessor &pluginProcessor, CustomLookAndFeel &customLookAndFeel) :
       processor(pluginProcessor),
       lookAndFeel(customLookAndFeel) {
-      this->startTimer(40);
+      // Only watches for playback to start or stop, the playhead itself
+      // moves on the display's refresh
+      this->startTimerHz(idleCheckHz);
     }
 
     ~SimplePositionOverlay () {
@@ -20,32 +28,86 @@ class SimplePositionOverlay :
     }
 
     void paint (juce::Graphics &g) override {
-      auto numSamples = this->processor.getNumSamples();
-
-      if (numSamples <= 0) {
+      if (this->drawnX < 0) {
         return;
       }
 
-      int position = this->processor.getPosition();
-      float percentage = (float) position / numSamples;
-      float drawPosition = (percentage * 656) + 16;
       g.setColour(this->lookAndFeel.COLOUR_BLACK);
       g.drawLine(
-        drawPosition,
+        (float) this->drawnX + 0.5f,
         0.0f,
-        drawPosition,
+        (float) this->drawnX + 0.5f,
         static_cast<float>(getHeight()),
         1.0f
       );
     }
 
   private:
-    void timerCallback () override {
-      this->repaint();
-    }
+    static constexpr int idleCheckHz = 5;
 
     PluginProcessor &processor;
     CustomLookAndFeel &lookAndFeel;
 
+    /**
+     * Attached while playing, so a stopped playhead costs no callbacks at
+     * the refresh rate
+     */
+    std::unique_ptr<juce::VBlankAttachment> vBlankAttachment;
+
+    /**
+     * Column of the line on screen, negative when none is drawn
+     */
+    int drawnX = -1;
+
+    void timerCallback () override {
+      bool isPlaying = this->processor.getPlayheadPosition() >= 0;
+
+      if (isPlaying && this->vBlankAttachment == nullptr) {
+        this->vBlankAttachment = std::make_unique<juce::VBlankAttachment>(this, [this] { this->updatePlayhead(); });
+      } else if (!isPlaying && this->vBlankAttachment != nullptr) {
+        this->vBlankAttachment.reset();
+        this->updatePlayhead();
+      }
+    }
+
+    void updatePlayhead () {
+      this->moveTo(this->getPlayheadX());
+    }
+
+    /**
+     * @return The column of the playhead, negative while nothing plays
+     */
+    int getPlayheadX () const {
+      double position = this->processor.getPlayheadPosition();
+      int numSamples = this->processor.getNumSamples();
+
+      if (position < 0 || numSamples <= 0) {
+        return -1;
+      }
+
+      int width = juce::jmax(0, this->getWidth() - 2 * inset);
+
+      return inset + juce::roundToInt(position / numSamples * width);
+    }
+
+    /**
+     * Repaint only the strips under the old and the new line
+     */
+    void moveTo (int x) {
+      if (x == this->drawnX) {
+        return;
+      }
+
+      if (this->drawnX >= 0) {
+        this->repaint(this->drawnX - 1, 0, 3, this->getHeight());
+      }
+
+      if (x >= 0) {
+        this->repaint(x - 1, 0, 3, this->getHeight());
+      }
+
+      this->drawnX = x;
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SimplePositionOverlay)
 };
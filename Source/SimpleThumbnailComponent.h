@@ -1,29 +1,34 @@
 #pragma once
 
 #include <juce_gui_basics/juce_gui_basics.h>
-#include <juce_audio_utils/juce_audio_utils.h>
+#include "PeakPyramid.h"
 
 class SimpleThumbnailComponent :
   public juce::Component,
   public juce::ChangeListener {
   public:
     SimpleThumbnailComponent (
-      juce::AudioThumbnail &t,
-      [[maybe_unused]] juce::AudioThumbnailCache &cache,
+      SharedPeakPyramid &peaks,
       CustomLookAndFeel &laf
     ) :
-      thumbnail(t),
+      sharedPeaks(peaks),
       lookAndFeel(laf) {
-      this->thumbnail.addChangeListener(this);
+      this->sharedPeaks.addChangeListener(this);
+    }
+
+    ~SimpleThumbnailComponent () override {
+      this->sharedPeaks.removeChangeListener(this);
     }
 
     void paint (juce::Graphics &g) override {
-      if (this->thumbnail.getNumChannels() == 0) {
+      auto peaks = this->sharedPeaks.get();
+
+      if (peaks == nullptr || peaks->getNumChannels() == 0 || peaks->getNumSamples() == 0) {
         this->paintIfNoFileLoaded(g);
         return;
       }
 
-      this->paintIfFileLoaded(g);
+      this->paintIfFileLoaded(g, *peaks);
     }
 
     void paintIfNoFileLoaded (juce::Graphics &g) {
@@ -37,20 +42,40 @@ class SimpleThumbnailComponent :
       );
     }
 
-    void paintIfFileLoaded (juce::Graphics &g) {
+    /**
+     * Draw every channel in a lane of its own, one min/max line per pixel
+     * column read from the pyramid level matching the zoom
+     */
+    void paintIfFileLoaded (juce::Graphics &g, const PeakPyramid &peaks) {
       g.fillAll(this->lookAndFeel.COLOUR_WHITE);
       g.setColour(this->lookAndFeel.COLOUR_RED);
-      this->thumbnail.drawChannels(
-        g,
-        getLocalBounds(),
-        0.0,
-        this->thumbnail.getTotalLength(),
-        1.0f
-      );
+
+      int width = this->getWidth();
+      int numChannels = peaks.getNumChannels();
+      float laneHeight = (float) this->getHeight() / (float) numChannels;
+      double samplesPerPixel = (double) peaks.getNumSamples() / juce::jmax(1, width);
+
+      for (int channel = 0; channel < numChannels; channel++) {
+        float centre = laneHeight * ((float) channel + 0.5f);
+        float halfHeight = laneHeight * 0.5f;
+
+        for (int x = 0; x < width; x++) {
+          auto range = peaks.getRange(
+            channel,
+            (int) (x * samplesPerPixel),
+            juce::jmax((int) ((x + 1) * samplesPerPixel), (int) (x * samplesPerPixel) + 1)
+          );
+
+          float top = centre - juce::jlimit(-1.0f, 1.0f, range.getEnd()) * halfHeight;
+          float bottom = centre - juce::jlimit(-1.0f, 1.0f, range.getStart()) * halfHeight;
+
+          g.fillRect(juce::Rectangle<float>((float) x, top, 1.0f, juce::jmax(1.0f, bottom - top)));
+        }
+      }
     }
 
     void changeListenerCallback (juce::ChangeBroadcaster *source) override {
-      if (source == &this->thumbnail) {
+      if (source == &this->sharedPeaks) {
         this->thumbnailChanged();
       }
     }
@@ -60,7 +85,7 @@ class SimpleThumbnailComponent :
       this->repaint();
     }
 
-    juce::AudioThumbnail &thumbnail;
+    SharedPeakPyramid &sharedPeaks;
     CustomLookAndFeel &lookAndFeel;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SimpleThumbnailComponent)
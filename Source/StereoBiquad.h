@@ -0,0 +1,218 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+
+/**
+ * Biquad filter running all channels of a frame together, one channel per
+ * lane of a SIMD register, in transposed direct form II
+ */
+class StereoBiquad {
+  public:
+    using Register = juce::dsp::SIMDRegister<float>;
+
+    /**
+     * Channels beyond the number of lanes are left unfiltered
+     */
+    static constexpr int maxChannels = (int) Register::SIMDNumElements;
+
+    /**
+     * Coefficients normalized by a0
+     */
+    struct Coefficients {
+      float b0 = 1;
+      float b1 = 0;
+      float b2 = 0;
+      float a1 = 0;
+      float a2 = 0;
+    };
+
+    /**
+     * Design resonant low or high pass coefficients for many frequency and
+     * resonance pairs at once.
+     *
+     * This is the bilinear transform design of IIRCoefficients, written with
+     * half angle sines and cosines so it needs no tan and keeps its precision
+     * at low cutoffs. The polynomial approximations are branch free, so the
+     * loop vectorizes.
+     *
+     * @param highPass
+     * @param sampleRate
+     * @param frequencies Below half the sample rate
+     * @param resonances Q of every pair
+     * @param numCoefficients
+     * @param coefficients Receives one set per pair
+     */
+    static void design (
+      bool highPass,
+      double sampleRate,
+      const float *frequencies,
+      const float *resonances,
+      int numCoefficients,
+      Coefficients *coefficients
+    ) {
+      using Approximations = juce::dsp::FastMathApproximations;
+
+      const auto halfAngleScale = (float) (juce::MathConstants<double>::pi / sampleRate);
+
+      for (int i = 0; i < numCoefficients; i++) {
+        float halfAngle = frequencies[i] * halfAngleScale;
+        float sinHalf = Approximations::sin(halfAngle);
+        float cosHalf = Approximations::cos(halfAngle);
+
+        // sin w = 2 sin(w/2) cos(w/2), cos w = 1 - 2 sin(w/2)^2
+        float alpha = sinHalf * cosHalf / resonances[i];
+        float inverseA0 = 1.0f / (1.0f + alpha);
+        float gain = (highPass ? cosHalf * cosHalf : sinHalf * sinHalf) * inverseA0;
+
+        coefficients[i].b0 = gain;
+        coefficients[i].b1 = (highPass ? -2.0f : 2.0f) * gain;
+        coefficients[i].b2 = gain;
+        coefficients[i].a1 = -2.0f * (1.0f - 2.0f * sinHalf * sinHalf) * inverseA0;
+        coefficients[i].a2 = (1.0f - alpha) * inverseA0;
+      }
+    }
+
+    StereoBiquad () {
+      // Pass through until the first coefficients arrive
+      this->b0 = Register::expand(1.0f);
+      this->b1 = this->b2 = this->a1 = this->a2 = Register::expand(0.0f);
+      this->reset();
+    }
+
+    /**
+     * Clear the filter state, keeping the coefficients
+     */
+    void reset () {
+      this->s1 = Register::expand(0.0f);
+      this->s2 = Register::expand(0.0f);
+    }
+
+    /**
+     * Switch to new coefficients, applied to every channel
+     *
+     * @param coefficients Normalized as b0, b1, b2, a1, a2
+     */
+    void setCoefficients (const juce::IIRCoefficients &coefficients) {
+      this->b0 = Register::expand(coefficients.coefficients[0]);
+      this->b1 = Register::expand(coefficients.coefficients[1]);
+      this->b2 = Register::expand(coefficients.coefficients[2]);
+      this->a1 = Register::expand(coefficients.coefficients[3]);
+      this->a2 = Register::expand(coefficients.coefficients[4]);
+    }
+
+    /**
+     * Switch to new coefficients, applied to every channel
+     *
+     * @param coefficients
+     */
+    void setCoefficients (const Coefficients &coefficients) {
+      this->b0 = Register::expand(coefficients.b0);
+      this->b1 = Register::expand(coefficients.b1);
+      this->b2 = Register::expand(coefficients.b2);
+      this->a1 = Register::expand(coefficients.a1);
+      this->a2 = Register::expand(coefficients.a2);
+    }
+
+    /**
+     * Filter a span of the buffer in place while moving the coefficients
+     * linearly to new ones, which are reached on the last sample
+     *
+     * @param buffer
+     * @param startSample
+     * @param numSamples
+     * @param target
+     */
+    void process (
+      juce::AudioBuffer<float> &buffer,
+      int startSample,
+      int numSamples,
+      const Coefficients &target
+    ) {
+      if (numSamples <= 0) {
+        return;
+      }
+
+      auto step = Register::expand(1.0f / (float) numSamples);
+      this->db0 = (Register::expand(target.b0) - this->b0) * step;
+      this->db1 = (Register::expand(target.b1) - this->b1) * step;
+      this->db2 = (Register::expand(target.b2) - this->b2) * step;
+      this->da1 = (Register::expand(target.a1) - this->a1) * step;
+      this->da2 = (Register::expand(target.a2) - this->a2) * step;
+
+      this->run<true>(buffer, startSample, numSamples);
+
+      // Exact target, whatever rounding the increments accumulated
+      this->setCoefficients(target);
+    }
+
+    /**
+     * Filter a span of the buffer in place
+     *
+     * @param buffer
+     * @param startSample
+     * @param numSamples
+     */
+    void process (juce::AudioBuffer<float> &buffer, int startSample, int numSamples) {
+      this->run<false>(buffer, startSample, numSamples);
+    }
+
+  private:
+    Register b0, b1, b2, a1, a2;
+    Register s1, s2;
+
+    /**
+     * Per sample coefficient increments while ramping
+     */
+    Register db0, db1, db2, da1, da2;
+
+    template<bool ramp>
+    void run (juce::AudioBuffer<float> &buffer, int startSample, int numSamples) {
+      int numChannels = juce::jmin(buffer.getNumChannels(), maxChannels);
+
+      if (numChannels <= 0) {
+        return;
+      }
+
+      float *channels[maxChannels];
+      for (int channel = 0; channel < numChannels; channel++) {
+        channels[channel] = buffer.getWritePointer(channel, startSample);
+      }
+
+      alignas(Register::SIMDRegisterSize) float frame[maxChannels] = {};
+
+      Register state1 = this->s1;
+      Register state2 = this->s2;
+
+      for (int i = 0; i < numSamples; i++) {
+        for (int channel = 0; channel < numChannels; channel++) {
+          frame[channel] = channels[channel][i];
+        }
+
+        Register x = Register::fromRawArray(frame);
+        Register y = this->b0 * x + state1;
+
+        state1 = this->b1 * x - this->a1 * y + state2;
+        state2 = this->b2 * x - this->a2 * y;
+
+        if constexpr (ramp) {
+          this->b0 += this->db0;
+          this->b1 += this->db1;
+          this->b2 += this->db2;
+          this->a1 += this->da1;
+          this->a2 += this->da2;
+        }
+
+        y.copyToRawArray(frame);
+
+        for (int channel = 0; channel < numChannels; channel++) {
+          channels[channel][i] = frame[channel];
+        }
+      }
+
+      this->s1 = state1;
+      this->s2 = state2;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StereoBiquad)
+};
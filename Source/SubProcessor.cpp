@@ -4,89 +4,87 @@
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_dsp/juce_dsp.h>
 #include <SoundTouch.h>
+#include "FeedbackDelay.h"
 #include "GUIParams.h"
+#include "OfflineConvolution.h"
 #include "SubProcessor.h"
 
 SubProcessor::SubProcessor (
   ThreadType threadType,
   juce::AudioBuffer<float> &audioBuffer,
-  GUIParams &guiParams
+  GUIParams &guiParams,
+  RenderProfiler *renderProfiler
 ) :
   bufferIn(audioBuffer),
   parameters(guiParams),
   type(threadType),
+  profiler(renderProfiler),
   sampleRate(-1),
   bpm(0),
-  lastIRName(nullptr) {
-  this->soundTouch.setChannels(1); // always iterate over single channels
-  this->soundTouch.setSampleRate(static_cast<uint>(this->sampleRate));
+  lastIRId(-1) {
 }
 
 void SubProcessor::applyTimeWarp (int factor) {
   float realFactor = factor < 0 ? (1.0f / abs(factor)) : (1.0f * factor);
+  int numChannels = this->bufferIn.getNumChannels();
+  int numSamples = this->bufferIn.getNumSamples();
 
-  juce::AudioBuffer<float> copy;
-  copy.makeCopyOf(this->bufferIn);
+  std::vector<std::vector<float>> warped(static_cast<size_t>(numChannels));
 
-  this->soundTouch.setTempo(realFactor);
+  this->workers.parallelFor(numChannels, [&] (int channel) {
+    soundtouch::SoundTouch *soundTouch = this->soundTouchChannels[channel];
+    std::vector<float> &channelOut = warped[static_cast<size_t>(channel)];
 
-  double ratio = this->soundTouch.getInputOutputSampleRatio();
+    soundTouch->clear();
+    soundTouch->setTempo(realFactor);
 
-  this->bufferIn.setSize(
-    this->bufferIn.getNumChannels(),
-    static_cast<int>(ceil(this->bufferIn.getNumSamples() * ratio)),
-    false, true, AVOID_REALLOCATING
-  );
-
-  for (int channel = 0; channel < this->bufferIn.getNumChannels(); channel++) {
-    this->soundTouch.putSamples(
-      copy.getReadPointer(channel),
-      static_cast<uint>(copy.getNumSamples())
+    soundTouch->putSamples(
+      this->bufferIn.getReadPointer(channel),
+      static_cast<uint>(numSamples)
     );
 
-    this->soundTouch.receiveSamples(
-      bufferIn.getWritePointer(channel),
-      static_cast<uint>(this->bufferIn.getNumSamples())
+    // Push the tail still sitting in the pipeline to the output
+    soundTouch->flush();
+
+    channelOut.resize(soundTouch->numSamples());
+    soundTouch->receiveSamples(
+      channelOut.data(),
+      static_cast<uint>(channelOut.size())
     );
 
-    this->soundTouch.clear();
-  }
-}
+    soundTouch->clear();
+  });
 
-void SubProcessor::applyDelay (
-  juce::AudioBuffer<float> &base,
-  const float dampen,
-  const int delayTimeInSamples,
-  int iteration
-) {
-  base.applyGain(dampen);
-  bool continueIteration = base.getMagnitude(0, base.getNumSamples()) > 0.001f;
-  int currentDelayPosition = delayTimeInSamples * iteration;
-  int length = this->bufferIn.getNumSamples() + base.getNumSamples() + delayTimeInSamples;
+  size_t warpedNumSamples = 0;
+  for (const auto &channelOut: warped) {
+    warpedNumSamples = juce::jmax(warpedNumSamples, channelOut.size());
+  }
 
   this->bufferIn.setSize(
-    this->bufferIn.getNumChannels(),
-    length,
-    true,
-    true,
-    AVOID_REALLOCATING
+    numChannels,
+    static_cast<int>(warpedNumSamples),
+    false, true, AVOID_REALLOCATING
   );
 
-  for (int channel = 0; channel < this->bufferIn.getNumChannels(); channel++) {
-    for (int i = 0; i < base.getNumSamples(); i++) {
-      this->bufferIn.addSample(
-        channel, i + currentDelayPosition,
-        base.getSample(channel, i));
-    }
-  }
+  for (int channel = 0; channel < numChannels; channel++) {
+    const std::vector<float> &channelOut = warped[static_cast<size_t>(channel)];
+    auto channelNumSamples = static_cast<int>(channelOut.size());
 
-  if (continueIteration) {
-    applyDelay(base, dampen, delayTimeInSamples, iteration + 1);
+    this->bufferIn.copyFrom(channel, 0, channelOut.data(), channelNumSamples);
+    this->bufferIn.clear(channel, channelNumSamples, this->bufferIn.getNumSamples() - channelNumSamples);
   }
 }
 
+void SubProcessor::applyDelay (
+  const float mix,
+  const float feedback,
+  const int delayTimeInSamples
+) {
+  FeedbackDelay::render(this->bufferIn, mix, feedback, delayTimeInSamples);
+}
+
 void SubProcessor::applyReverb (float mix) {
-  int irSize = this->convolution.getCurrentIRSize();
+  int irSize = this->convolution.getImpulseResponseLength();
 
 #if DEBUG
   std::cout << "Reverb Params: IR size " << irSize << ", Mix " << mix << std::endl;
@@ -96,117 +94,161 @@ void SubProcessor::applyReverb (float mix) {
     return;
   }
 
-  juce::AudioBuffer<float> copy;
-  copy.makeCopyOf(this->bufferIn);
-
-  const int processedSize = irSize + copy.getNumSamples() - 1;
-  this->bufferIn.setSize(
-    this->bufferIn.getNumChannels(),
-    processedSize,
-    false,
-    true,
-    AVOID_REALLOCATING
-  );
-
-  auto audioBlockIn = juce::dsp::AudioBlock<float>(copy);
-  auto audioBlockOut = juce::dsp::AudioBlock<float>(this->bufferIn);
-  auto processContext = juce::dsp::ProcessContextNonReplacing<float>(audioBlockIn, audioBlockOut);
+  juce::AudioBuffer<float> wet;
+  this->convolution.process(this->bufferIn, wet);
 
-  this->convolution.process(processContext);
+  wet.applyGain(mix);
 
-  bufferIn.applyGain(mix);
-
-  for (int channel = 0; channel < copy.getNumChannels(); channel++) {
-    this->bufferIn.addFrom(
+  for (int channel = 0; channel < this->bufferIn.getNumChannels(); channel++) {
+    wet.addFrom(
       channel,
       0,
-      copy,
+      this->bufferIn,
       channel,
       0,
-      copy.getNumSamples(),
+      this->bufferIn.getNumSamples(),
       1 - mix
     );
   }
+
+  this->bufferIn = std::move(wet);
 }
 
 void SubProcessor::prepareToPlay (double sampleRateIn, double bpmIn) {
   auto numChannels = this->bufferIn.getNumChannels();
 
-  this->sampleRate = sampleRateIn;
+  // The delay reads the tempo at process time, nothing to prepare for it
   this->bpm = bpmIn;
-  this->soundTouch.setSampleRate(static_cast<uint>(this->sampleRate));
-
-  this->convolution.prepare(
-    {
-      this->sampleRate,
-      static_cast<juce::uint32>(288000),
-      static_cast<juce::uint32>(numChannels)
-    }
-  );
+
+  if (
+    juce::approximatelyEqual(this->sampleRate, sampleRateIn) &&
+    this->soundTouchChannels.size() >= numChannels
+    ) {
+    return;
+  }
+
+  this->sampleRate = sampleRateIn;
+  this->numPreparations++;
+
+  while (this->soundTouchChannels.size() < numChannels) {
+    auto *soundTouch = this->soundTouchChannels.add(new soundtouch::SoundTouch());
+    soundTouch->setChannels(1); // always iterate over single channels
+  }
+
+  for (auto *soundTouch: this->soundTouchChannels) {
+    soundTouch->setSampleRate(static_cast<uint>(this->sampleRate));
+  }
 }
 
-void SubProcessor::prepareReverb (const void *sourceData, size_t sourceDataSize) {
+void SubProcessor::prepareReverb (int impulseResponseId) {
   auto numChannels = this->bufferIn.getNumChannels();
 
-  if (this->lastIRName == sourceData) {
+  if (
+    this->lastIRId == impulseResponseId &&
+    juce::approximatelyEqual(this->lastIRSampleRate, this->sampleRate) &&
+    this->lastIRNumChannels == numChannels
+    ) {
     return;
   }
 
-  this->lastIRName = sourceData;
+  this->lastIRId = impulseResponseId;
+  this->lastIRSampleRate = this->sampleRate;
+  this->lastIRNumChannels = numChannels;
+  this->numPreparations++;
 
-  this->convolution.loadImpulseResponse(
-    sourceData,
-    sourceDataSize,
-    numChannels > 1 ? juce::dsp::Convolution::Stereo::yes : juce::dsp::Convolution::Stereo::no,
-    juce::dsp::Convolution::Trim::yes,
-    0,
-    juce::dsp::Convolution::Normalise::yes
+  this->convolution.setImpulseResponse(
+    this->impulseResponses->get(impulseResponseId, this->sampleRate, numChannels)
   );
 }
 
-void SubProcessor::process () {
-  auto delayMix = (float) this->parameters.getParameterAsValue(DELAY_MIX_ID).getValue() / 100.0f;
-  auto reverbMix = (float) this->parameters.getParameterAsValue(REVERB_MIX_ID).getValue() / 100.0f;
+void SubProcessor::process (juce::uint64 sourceKey) {
+  auto delayMix = (float) this->parameters.getRawParameterValue(DELAY_MIX_ID)->load() / 100.0f;
+  auto reverbMix = (float) this->parameters.getRawParameterValue(REVERB_MIX_ID)->load() / 100.0f;
 
   juce::String reverbId = (this->type == RISE) ? RISE_REVERB_ID : FALL_REVERB_ID;
   juce::String delayId = (this->type == RISE) ? RISE_DELAY_ID : FALL_DELAY_ID;
   juce::String timeWarpId = (this->type == RISE) ? RISE_TIME_WARP_ID : FALL_TIME_WARP_ID;
   juce::String reverseId = (this->type == RISE) ? RISE_REVERSE_ID : FALL_REVERSE_ID;
 
-  auto reverbEnabled = (bool) this->parameters.getParameterAsValue(reverbId).getValue();
-  auto delayEnabled = (bool) this->parameters.getParameterAsValue(delayId).getValue();
-  auto timeWarp = (int) this->parameters.getParameterAsValue(timeWarpId).getValue();
-  auto reverse = (bool) this->parameters.getParameterAsValue(reverseId).getValue();
+  auto reverbEnabled = (bool) this->parameters.getRawParameterValue(reverbId)->load();
+  auto delayEnabled = (bool) this->parameters.getRawParameterValue(delayId)->load();
+  auto timeWarp = (int) this->parameters.getRawParameterValue(timeWarpId)->load();
+  auto reverse = (bool) this->parameters.getRawParameterValue(reverseId)->load();
 
-  if (timeWarp != 0) {
-    applyTimeWarp(timeWarp);
+  auto delayFeedbackNormalized = (float) this->parameters.getRawParameterValue(DELAY_FEEDBACK_ID)->load() / 100.0f;
+  auto delayNoteIndex = (float) this->parameters.getRawParameterValue(DELAY_TIME_ID)->load();
+  int samplesPerBeat = (int) ceil((60.0f / this->bpm) * this->sampleRate);
+  int delayTimeInSamples;
+
+  double delayNote = pow(2, abs(delayNoteIndex));
+
+  if (delayNoteIndex > 0) {
+    delayTimeInSamples = (int) (delayNote * 4 * samplesPerBeat);
+  } else {
+    delayTimeInSamples = (int) ceil(samplesPerBeat / (abs(delayNote) * 4));
   }
 
-  if (reverbEnabled && reverbMix > 0) {
-    applyReverb(reverbMix);
+  // Each key covers the source and every parameter of the stages up to and
+  // including its own, so a matching key means an identical output
+  juce::uint64 key = SubProcessor::hashCombine(sourceKey, this->sampleRate);
+
+  bool timeWarpEnabled = timeWarp != 0;
+  if (timeWarpEnabled) {
+    key = SubProcessor::hashCombine(key, timeWarp);
+  }
+  juce::uint64 timeWarpKey = key;
+
+  reverbEnabled = reverbEnabled && reverbMix > 0;
+  if (reverbEnabled) {
+    key = SubProcessor::hashCombine(key, this->lastIRId);
+    key = SubProcessor::hashCombine(key, reverbMix);
+  }
+  juce::uint64 reverbKey = key;
+
+  delayEnabled = delayEnabled && delayMix > 0;
+  if (delayEnabled) {
+    key = SubProcessor::hashCombine(key, delayMix);
+    key = SubProcessor::hashCombine(key, delayFeedbackNormalized);
+    key = SubProcessor::hashCombine(key, delayTimeInSamples);
+  }
+  juce::uint64 delayKey = key;
+
+  // Resume after the last stage whose cached output is still valid
+  int firstDirtyStage = TIME_WARP_STAGE;
+  if (delayEnabled && this->delayCache.matches(delayKey)) {
+    this->bufferIn.makeCopyOf(this->delayCache.output);
+    firstDirtyStage = REVERSE_STAGE;
+  } else if (reverbEnabled && this->reverbCache.matches(reverbKey)) {
+    this->bufferIn.makeCopyOf(this->reverbCache.output);
+    firstDirtyStage = DELAY_STAGE;
+  } else if (timeWarpEnabled && this->timeWarpCache.matches(timeWarpKey)) {
+    this->bufferIn.makeCopyOf(this->timeWarpCache.output);
+    firstDirtyStage = REVERB_STAGE;
   }
 
-  if (delayEnabled && delayMix > 0) {
-    juce::AudioBuffer<float> delayBaseBuffer;
-    auto delayFeedbackNormalized = (float) this->parameters.getParameterAsValue(DELAY_FEEDBACK_ID).getValue() / 100.0f;
-    auto delayNoteIndex = (float) this->parameters.getParameterAsValue(DELAY_TIME_ID).getValue();
-    int samplesPerBeat = (int) ceil((60.0f / this->bpm) * this->sampleRate);
-    int delayTimeInSamples;
+  // String literals, the profiler keeps only the pointers
+  const bool rise = this->type == RISE;
 
-    double delayNote = pow(2, abs(delayNoteIndex));
+  if (timeWarpEnabled && firstDirtyStage <= TIME_WARP_STAGE) {
+    RenderProfiler::ScopedTimer timer(this->profiler, rise ? "rise time warp" : "fall time warp");
+    applyTimeWarp(timeWarp);
+    this->timeWarpCache.store(timeWarpKey, this->bufferIn);
+  }
 
-    if (delayNoteIndex > 0) {
-      delayTimeInSamples = (int) (delayNote * 4 * samplesPerBeat);
-    } else {
-      delayTimeInSamples = (int) ceil(samplesPerBeat / (abs(delayNote) * 4));
-    }
+  if (reverbEnabled && firstDirtyStage <= REVERB_STAGE) {
+    RenderProfiler::ScopedTimer timer(this->profiler, rise ? "rise reverb" : "fall reverb");
+    applyReverb(reverbMix);
+    this->reverbCache.store(reverbKey, this->bufferIn);
+  }
 
-    delayBaseBuffer.makeCopyOf(this->bufferIn);
-    delayBaseBuffer.applyGain(delayMix);
-    applyDelay(delayBaseBuffer, delayFeedbackNormalized, delayTimeInSamples, 1);
+  if (delayEnabled && firstDirtyStage <= DELAY_STAGE) {
+    RenderProfiler::ScopedTimer timer(this->profiler, rise ? "rise delay" : "fall delay");
+    applyDelay(delayMix, delayFeedbackNormalized, delayTimeInSamples);
+    this->delayCache.store(delayKey, this->bufferIn);
   }
 
   if (reverse) {
+    RenderProfiler::ScopedTimer timer(this->profiler, rise ? "rise reverse" : "fall reverse");
     this->bufferIn.reverse(0, this->bufferIn.getNumSamples());
   }
 }
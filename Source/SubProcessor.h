@@ -4,6 +4,10 @@
 #include <juce_dsp/juce_dsp.h>
 #include <soundtouch/SoundTouch.h>
 #include "GUIParams.h"
+#include "ImpulseResponseCache.h"
+#include "OfflineConvolution.h"
+#include "RenderProfiler.h"
+#include "WorkerPool.h"
 
 typedef enum ThreadTypeEnum {
   RISE = 0,
@@ -12,38 +16,110 @@ typedef enum ThreadTypeEnum {
 
 class SubProcessor {
   public:
+    /**
+     * @param threadType
+     * @param audioBuffer
+     * @param guiParams
+     * @param renderProfiler Receives the stage durations, optional
+     */
     SubProcessor (
       ThreadType threadType,
       juce::AudioBuffer<float> &audioBuffer,
-      GUIParams &guiParams
+      GUIParams &guiParams,
+      RenderProfiler *renderProfiler = nullptr
     );
 
     ~SubProcessor ();
 
-    void process ();
+    /**
+     * Run the stages on the buffer, reusing cached stage outputs where the
+     * input and parameters have not changed
+     *
+     * @param sourceKey Identifies the content the buffer was filled with
+     */
+    void process (juce::uint64 sourceKey);
 
+    /**
+     * Prepare the time warp for the sample rate and the buffer's channels,
+     * skipped when neither changed since the last call
+     *
+     * @param sampleRate
+     * @param bpm
+     */
     void prepareToPlay (double sampleRate, double bpm);
 
-    void prepareReverb (const void *sourceData, size_t sourceDataSize);
+    /**
+     * Switch the reverb to an impulse response from the shared cache
+     *
+     * @param impulseResponseId Index of the IMPULSE_RESPONSE choice
+     */
+    void prepareReverb (int impulseResponseId);
+
+    /**
+     * @return How often prepareToPlay and prepareReverb actually had work to do
+     */
+    int getNumPreparations () const { return this->numPreparations; }
 
   private:
     juce::AudioBuffer<float> &bufferIn;
     GUIParams &parameters;
     ThreadType type;
+    RenderProfiler *profiler;
     double sampleRate;
     double bpm;
+    int numPreparations = 0;
+
+    int lastIRId;
+    double lastIRSampleRate = 0;
+    int lastIRNumChannels = 0;
 
-    const void *lastIRName;
+    typedef enum StageEnum {
+      TIME_WARP_STAGE = 0,
+      REVERB_STAGE,
+      DELAY_STAGE,
+      REVERSE_STAGE
+    } Stage;
 
     /**
-     * SoundTouch instance for time warping
+     * Output of a stage, keyed by a hash of its input and its parameters
      */
-    soundtouch::SoundTouch soundTouch;
+    struct StageCache {
+      juce::uint64 key = 0;
+      juce::AudioBuffer<float> output;
+
+      bool matches (juce::uint64 otherKey) const {
+        return this->output.getNumChannels() > 0 && this->key == otherKey;
+      }
+
+      void store (juce::uint64 newKey, const juce::AudioBuffer<float> &buffer) {
+        this->key = newKey;
+        this->output.makeCopyOf(buffer);
+      }
+    };
+
+    StageCache timeWarpCache;
+    StageCache reverbCache;
+    StageCache delayCache;
+
+    /**
+     * SoundTouch instances for time warping, one per channel
+     */
+    juce::OwnedArray<soundtouch::SoundTouch> soundTouchChannels;
+
+    /**
+     * Runs the channels of a stage concurrently
+     */
+    WorkerPool workers;
 
     /**
      * Convolution engine for the reverb effect
      */
-    juce::dsp::Convolution convolution;
+    OfflineConvolution convolution;
+
+    /**
+     * Impulse responses shared by all instances
+     */
+    juce::SharedResourcePointer<ImpulseResponseCache> impulseResponses;
 
     /**
      * Warp audio samples to change the speed and pitch
@@ -54,18 +130,16 @@ class SubProcessor {
     void applyTimeWarp (int factor);
 
     /**
+     * Append feedback echoes of the buffer
      *
-     * @param target
-     * @param base
-     * @param dampen
+     * @param mix
+     * @param feedback
      * @param delayTimeInSamples
-     * @param iteration
      */
     void applyDelay (
-      juce::AudioBuffer<float> &base,
-      float dampen,
-      int delayTimeInSamples,
-      int iteration
+      float mix,
+      float feedback,
+      int delayTimeInSamples
     );
 
     /**
@@ -74,5 +148,10 @@ class SubProcessor {
      */
     void applyReverb (float mix);
 
+    template<typename T>
+    static juce::uint64 hashCombine (juce::uint64 seed, const T &value) {
+      return seed ^ (std::hash<T>{}(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SubProcessor)
 };
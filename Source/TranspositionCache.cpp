@@ -0,0 +1,240 @@
+#include <soundtouch/SoundTouch.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "AudioBufferUtils.h"
+#include "TranspositionCache.h"
+
+TranspositionCache::TranspositionCache (size_t memoryBudgetIn, std::function<void ()> onRequestIn) :
+  memoryBudget(memoryBudgetIn),
+  onRequest(std::move(onRequestIn)) {
+}
+
+TranspositionCache::~TranspositionCache () {
+  for (auto &slot: this->slots) {
+    delete slot.transposition.exchange(nullptr);
+  }
+
+  for (const auto &entry: this->retired) {
+    delete entry.transposition;
+  }
+
+  this->sharedBudget->release(this->memoryUsage);
+}
+
+void TranspositionCache::beginBlock () noexcept {
+  this->blockCounter++;
+}
+
+void TranspositionCache::endBlock () noexcept {
+  this->blockCounter++;
+}
+
+const RenderedSample *TranspositionCache::get (int semitones) noexcept {
+  if (semitones == 0 || std::abs(semitones) > maxSemitones) {
+    return nullptr;
+  }
+
+  Slot &slot = this->slots[(size_t) (semitones + maxSemitones)];
+  slot.lastUsed.store(this->blockCounter.load());
+
+  const RenderedSample *transposition = slot.transposition.load();
+
+  // Requests stay flagged until built, so only the first lookup wakes the
+  // builder
+  if (transposition == nullptr && !slot.requested.exchange(true) && this->onRequest) {
+    this->onRequest();
+  }
+
+  return transposition;
+}
+
+void TranspositionCache::invalidate () {
+  for (auto &slot: this->slots) {
+    if (slot.transposition.load() != nullptr) {
+      this->retire(slot);
+      slot.requested.store(true);
+    }
+  }
+
+  this->tooLarge = false;
+  this->collectGarbage();
+}
+
+bool TranspositionCache::buildNext (const RenderedSample &base) {
+  this->collectGarbage();
+
+  // The transposition looked up most recently is the one a voice is
+  // waiting for
+  int next = -1;
+
+  for (int index = 0; index < numSlots; index++) {
+    const Slot &slot = this->slots[(size_t) index];
+
+    if (!slot.requested.load()) {
+      continue;
+    }
+
+    if (next < 0 || slot.lastUsed.load() > this->slots[(size_t) next].lastUsed.load()) {
+      next = index;
+    }
+  }
+
+  if (next < 0) {
+    return false;
+  }
+
+  Slot &slot = this->slots[(size_t) next];
+
+  if (slot.transposition.load() != nullptr) {
+    slot.requested.store(false);
+    return false;
+  }
+
+  // The requests that can't be built now stay flagged, to be retried on the
+  // builder's idle interval rather than woken up for on every lookup
+  if (this->tooLarge) {
+    return false;
+  }
+
+  size_t numBytes = TranspositionCache::getNumBytes(base);
+
+  // Voices keep playing the untransposed render rather than having the
+  // same transposition rebuilt and thrown away on every request
+  if (numBytes > this->memoryBudget) {
+    this->tooLarge = true;
+    return false;
+  }
+
+  while (this->memoryUsage + numBytes > this->memoryBudget) {
+    if (!this->evictLeastRecentlyUsed()) {
+      break;
+    }
+  }
+
+  // Evicting only helps when this cache holds enough to cover what the
+  // other instances leave of the shared budget. Otherwise nothing is
+  // evicted, and the transposition stays requested and may fit once they
+  // release some.
+  while (!this->sharedBudget->tryReserve(numBytes)) {
+    if (this->sharedBudget->getAvailable() + this->memoryUsage < numBytes || !this->evictLeastRecentlyUsed()) {
+      return false;
+    }
+  }
+
+  auto transposition = this->transpose(base, next - maxSemitones);
+  slot.requested.store(false);
+
+  slot.numBytes = numBytes;
+  this->memoryUsage += numBytes;
+  slot.transposition.store(transposition.release());
+
+  return true;
+}
+
+void TranspositionCache::retire (Slot &slot) {
+  const RenderedSample *transposition = slot.transposition.exchange(nullptr);
+
+  if (transposition == nullptr) {
+    return;
+  }
+
+  this->memoryUsage -= slot.numBytes;
+  this->sharedBudget->release(slot.numBytes);
+  slot.numBytes = 0;
+
+  // A block that looks up the slot from now on finds it empty, only the
+  // block running right now can still be reading the old transposition
+  this->retired.push_back({transposition, this->blockCounter.load()});
+}
+
+bool TranspositionCache::evictLeastRecentlyUsed () {
+  Slot *leastRecentlyUsed = nullptr;
+
+  for (auto &slot: this->slots) {
+    if (
+      slot.transposition.load() != nullptr &&
+      (leastRecentlyUsed == nullptr || slot.lastUsed.load() < leastRecentlyUsed->lastUsed.load())
+      ) {
+      leastRecentlyUsed = &slot;
+    }
+  }
+
+  if (leastRecentlyUsed == nullptr) {
+    return false;
+  }
+
+  this->retire(*leastRecentlyUsed);
+
+  return true;
+}
+
+void TranspositionCache::collectGarbage () {
+  juce::uint64 now = this->blockCounter.load();
+
+  auto isFree = [now] (const Retired &entry) {
+    return entry.blockCounter % 2 == 0 || entry.blockCounter != now;
+  };
+
+  for (const auto &entry: this->retired) {
+    if (isFree(entry)) {
+      delete entry.transposition;
+    }
+  }
+
+  this->retired.erase(
+    std::remove_if(this->retired.begin(), this->retired.end(), isFree),
+    this->retired.end()
+  );
+}
+
+std::unique_ptr<RenderedSample> TranspositionCache::transpose (const RenderedSample &base, int semitones) {
+  const juce::AudioBuffer<float> *sources[] = {&base.getRise(), &base.getFall()};
+  juce::AudioBuffer<float> outputs[2];
+  int numChannels = base.getNumChannels();
+
+  for (int index = 0; index < 2; index++) {
+    outputs[index].setSize(numChannels, sources[index]->getNumSamples());
+    outputs[index].clear();
+  }
+
+  // Every channel of the rise and the fall goes through its own SoundTouch
+  this->workers.parallelFor(2 * numChannels, [&] (int task) {
+    const juce::AudioBuffer<float> &source = *sources[task / numChannels];
+    juce::AudioBuffer<float> &output = outputs[task / numChannels];
+    int channel = task % numChannels;
+    int numSamples = source.getNumSamples();
+
+    soundtouch::SoundTouch soundTouch;
+    soundTouch.setChannels(1);
+    soundTouch.setSampleRate(static_cast<uint>(base.getSampleRate()));
+    soundTouch.setPitchSemiTones(semitones);
+
+    soundTouch.putSamples(source.getReadPointer(channel), static_cast<uint>(numSamples));
+    soundTouch.flush();
+
+    // Pitch shifting keeps the duration, dropping the flushed tail keeps
+    // positions interchangeable with the untransposed render
+    soundTouch.receiveSamples(
+      output.getWritePointer(channel),
+      static_cast<uint>(numSamples)
+    );
+  });
+
+  for (auto &output: outputs) {
+    AudioBufferUtils::normalize(output);
+  }
+
+  return std::make_unique<RenderedSample>(
+    std::move(outputs[0]),
+    std::move(outputs[1]),
+    base.getSampleRate()
+  );
+}
+
+size_t TranspositionCache::getNumBytes (const RenderedSample &sample) {
+  auto numSamples = static_cast<size_t>(sample.getRise().getNumSamples() + sample.getFall().getNumSamples());
+
+  return numSamples * static_cast<size_t>(sample.getNumChannels()) * sizeof(float);
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "RenderedSample.h"
+#include "WorkerPool.h"
+
+/**
+ * Pitch shifted copies of the latest render, one per semitone, so that
+ * voices can follow the keyboard without any pitch work on the audio thread.
+ *
+ * The audio thread asks for a transposition with get. Missing ones are
+ * flagged and built on the render thread by buildNext, least recently used
+ * ones are evicted when the cache would outgrow its memory budget. Every
+ * cache in the process also draws from one shared budget, so the memory
+ * doesn't grow with the number of plugin instances.
+ *
+ * Transpositions are only valid for the block they were looked up in.
+ * Evicted copies are deleted once the audio thread has left that block.
+ */
+class TranspositionCache {
+  public:
+    static constexpr int maxSemitones = 24;
+    static constexpr int numSlots = maxSemitones * 2 + 1;
+
+    /**
+     * Bytes of transpositions across every cache in the process
+     */
+    static constexpr size_t sharedMemoryBudget = 256 * 1024 * 1024;
+
+    /**
+     * @param memoryBudgetIn Bytes this cache may hold at most, within the
+     *                       shared budget
+     * @param onRequestIn Called by the audio thread when a lookup first
+     *                    requests a missing transposition, to wake whatever
+     *                    calls buildNext
+     */
+    explicit TranspositionCache (
+      size_t memoryBudgetIn = sharedMemoryBudget,
+      std::function<void ()> onRequestIn = nullptr
+    );
+
+    ~TranspositionCache ();
+
+    /**
+     * Audio side: mark the start of a block, before any call to get
+     */
+    void beginBlock () noexcept;
+
+    /**
+     * Audio side: mark the end of a block, after the last use of a
+     * transposition returned by get
+     */
+    void endBlock () noexcept;
+
+    /**
+     * Audio side: look up a transposition, requesting it if it is missing
+     *
+     * @param semitones Nonzero, within maxSemitones either way
+     * @return The transposition or nullptr if it is not built yet
+     */
+    const RenderedSample *get (int semitones) noexcept;
+
+    /**
+     * Render side: drop every transposition of the previous render. The ones
+     * that were built are requested again, to be rebuilt from the next one.
+     */
+    void invalidate ();
+
+    /**
+     * Render side: build one requested transposition
+     *
+     * @param base Render to transpose
+     * @return Whether a transposition was built
+     */
+    bool buildNext (const RenderedSample &base);
+
+    /**
+     * Render side: delete evicted transpositions the audio thread is done with
+     */
+    void collectGarbage ();
+
+    /**
+     * @return Bytes held by the transpositions currently in the cache
+     */
+    size_t getMemoryUsage () const { return this->memoryUsage; }
+
+    /**
+     * Pitch shift the rise and the fall of a render, keeping their length
+     *
+     * @param base
+     * @param semitones
+     */
+    std::unique_ptr<RenderedSample> transpose (const RenderedSample &base, int semitones);
+
+  private:
+    struct Slot {
+      std::atomic<const RenderedSample *> transposition{nullptr};
+      std::atomic<bool> requested{false};
+
+      /**
+       * Block counter value when the audio thread last looked it up
+       */
+      std::atomic<juce::uint64> lastUsed{0};
+
+      /**
+       * Render side only
+       */
+      size_t numBytes = 0;
+    };
+
+    /**
+     * Bytes held by every cache in the process, each render thread reserves
+     * before building and releases when retiring
+     */
+    struct SharedBudget {
+      std::atomic<size_t> used{0};
+
+      bool tryReserve (size_t numBytes) noexcept {
+        size_t current = this->used.load();
+
+        do {
+          if (current + numBytes > sharedMemoryBudget) {
+            return false;
+          }
+        } while (!this->used.compare_exchange_weak(current, current + numBytes));
+
+        return true;
+      }
+
+      void release (size_t numBytes) noexcept {
+        this->used -= numBytes;
+      }
+
+      size_t getAvailable () const noexcept {
+        return sharedMemoryBudget - juce::jmin(sharedMemoryBudget, this->used.load());
+      }
+    };
+
+    struct Retired {
+      const RenderedSample *transposition;
+      juce::uint64 blockCounter;
+    };
+
+    std::array<Slot, numSlots> slots;
+
+    /**
+     * Incremented when the audio thread enters and leaves a block, so it is
+     * odd while a block is running
+     */
+    std::atomic<juce::uint64> blockCounter{0};
+
+    std::vector<Retired> retired;
+
+    juce::SharedResourcePointer<SharedBudget> sharedBudget;
+    size_t memoryBudget;
+    size_t memoryUsage = 0;
+
+    std::function<void ()> onRequest;
+
+    /**
+     * Set when a single transposition of the current render would not fit
+     * in the budget
+     */
+    bool tooLarge = false;
+
+    WorkerPool workers;
+
+    void retire (Slot &slot);
+
+    /**
+     * @return Whether a slot was evicted, false when none holds anything
+     */
+    bool evictLeastRecentlyUsed ();
+
+    static size_t getNumBytes (const RenderedSample &sample);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TranspositionCache)
+};
@@ -0,0 +1,240 @@
+#include "VoicePool.h"
+
+#include <cmath>
+
+void VoicePool::prepare (int numChannels, int maximumBlockSize, double sampleRate, bool loopIn) {
+  this->voices.assign(numVoices, Voice());
+  this->tails.assign(numTails, Voice());
+  this->scratch.setSize(numChannels, juce::jmax(maximumBlockSize, 512));
+  this->releaseStep = (float) (1.0 / juce::jmax(1.0, releaseSeconds * sampleRate));
+  this->loop = loopIn;
+  this->numTriggers = 0;
+  this->position.store(0);
+}
+
+void VoicePool::reset () {
+  for (auto &voice: this->voices) {
+    voice.active = false;
+  }
+
+  for (auto &tail: this->tails) {
+    tail.active = false;
+  }
+
+  this->position.store(0);
+}
+
+void VoicePool::noteOn (int note, float velocity) {
+  if (this->voices.empty()) {
+    return;
+  }
+
+  Voice *chosen = &this->voices[0];
+
+  for (auto &voice: this->voices) {
+    // A note restarts the loop rather than playing on top of it
+    if (voice.active && voice.automatic) {
+      chosen = &voice;
+      break;
+    }
+
+    if (!voice.active) {
+      chosen = &voice;
+      break;
+    }
+
+    if (voice.startedAt < chosen->startedAt) {
+      chosen = &voice;
+    }
+  }
+
+  // The voice restarts right away, its old sound is released from a tail
+  // instead of cutting off
+  if (chosen->active && !this->tails.empty()) {
+    Voice *tail = &this->tails[0];
+
+    for (auto &candidate: this->tails) {
+      if (!candidate.active) {
+        tail = &candidate;
+        break;
+      }
+
+      if (candidate.envelope < tail->envelope) {
+        tail = &candidate;
+      }
+    }
+
+    *tail = *chosen;
+    tail->releasing = true;
+  }
+
+  chosen->active = true;
+  chosen->releasing = false;
+  chosen->automatic = false;
+  chosen->note = note;
+  chosen->semitones = note < 0 ? 0 : juce::jlimit(
+    -TranspositionCache::maxSemitones,
+    TranspositionCache::maxSemitones,
+    note - rootNote
+  );
+  chosen->position = 0;
+  chosen->gain = velocity * headroom;
+  chosen->envelope = 1;
+  chosen->startedAt = ++this->numTriggers;
+}
+
+void VoicePool::noteOff (int note) {
+  for (auto &voice: this->voices) {
+    if (voice.active && voice.note == note) {
+      voice.releasing = true;
+    }
+  }
+}
+
+void VoicePool::allNotesOff () {
+  for (auto &voice: this->voices) {
+    voice.releasing = voice.active;
+  }
+}
+
+int VoicePool::getNumTriggeredVoices () const {
+  int numTriggered = 0;
+
+  for (const auto &voice: this->voices) {
+    numTriggered += voice.active && !voice.automatic ? 1 : 0;
+  }
+
+  return numTriggered;
+}
+
+int VoicePool::getNumActiveVoices () const {
+  int numActive = 0;
+
+  for (const auto &voice: this->voices) {
+    numActive += voice.active ? 1 : 0;
+  }
+
+  return numActive;
+}
+
+void VoicePool::render (
+  juce::AudioBuffer<float> &buffer,
+  int startSample,
+  int numSamples,
+  const RenderedSample &rendered,
+  int timeOffset,
+  TranspositionCache *transpositions
+) {
+  if (this->loop && !this->transportPlaying) {
+    for (auto &voice: this->voices) {
+      voice.releasing = voice.releasing || (voice.active && voice.automatic);
+    }
+  } else if (this->loop && this->getNumActiveVoices() == 0) {
+    this->noteOn(-1, 1.0f);
+
+    for (auto &voice: this->voices) {
+      voice.automatic = voice.active;
+    }
+  }
+
+  const Voice *newest = nullptr;
+
+  for (auto &voice: this->voices) {
+    if (!voice.active) {
+      continue;
+    }
+
+    this->renderVoice(voice, buffer, startSample, numSamples, rendered, timeOffset, transpositions);
+
+    if (voice.active && (newest == nullptr || voice.startedAt > newest->startedAt)) {
+      newest = &voice;
+    }
+  }
+
+  for (auto &tail: this->tails) {
+    if (tail.active) {
+      this->renderVoice(tail, buffer, startSample, numSamples, rendered, timeOffset, transpositions);
+    }
+  }
+
+  this->position.store(newest != nullptr ? newest->position : 0);
+}
+
+void VoicePool::renderVoice (
+  Voice &voice,
+  juce::AudioBuffer<float> &buffer,
+  int startSample,
+  int numSamples,
+  const RenderedSample &rendered,
+  int timeOffset,
+  TranspositionCache *transpositions
+) {
+  // Transpositions keep the length of the render, so a voice can switch
+  // over as soon as its transposition is built
+  const RenderedSample *source = &rendered;
+
+  if (transpositions != nullptr && voice.semitones != 0) {
+    if (const RenderedSample *transposition = transpositions->get(voice.semitones)) {
+      source = transposition;
+    }
+  }
+
+  this->renderVoice(voice, buffer, startSample, numSamples, *source, timeOffset);
+}
+
+void VoicePool::renderVoice (
+  Voice &voice,
+  juce::AudioBuffer<float> &buffer,
+  int startSample,
+  int numSamples,
+  const RenderedSample &rendered,
+  int timeOffset
+) {
+  int length = rendered.getNumSamples(timeOffset);
+  int numChannels = juce::jmin(buffer.getNumChannels(), this->scratch.getNumChannels());
+
+  for (int done = 0; done < numSamples && voice.active;) {
+    // A shorter offset or a new render can leave the position past the end
+    if (voice.position >= length) {
+      if (!this->loop) {
+        voice.active = false;
+        return;
+      }
+
+      voice.position = 0;
+    }
+
+    int samplesThisTime = juce::jmin(numSamples - done, length - voice.position);
+
+    if (!voice.releasing) {
+      rendered.addTo(buffer, startSample + done, voice.position, samplesThisTime, timeOffset, voice.gain);
+    } else {
+      // The fades of the mix are ramps already, so the release ramp is
+      // applied on a copy rather than folded into the same gain
+      int samplesLeft = (int) std::ceil(voice.envelope / this->releaseStep);
+      samplesThisTime = juce::jmin(samplesThisTime, this->scratch.getNumSamples(), juce::jmax(1, samplesLeft));
+
+      this->scratch.clear(0, samplesThisTime);
+      rendered.addTo(this->scratch, 0, voice.position, samplesThisTime, timeOffset, voice.gain);
+
+      float endEnvelope = juce::jmax(0.0f, voice.envelope - this->releaseStep * (float) samplesThisTime);
+
+      for (int channel = 0; channel < numChannels; channel++) {
+        buffer.addFromWithRamp(
+          channel,
+          startSample + done,
+          this->scratch.getReadPointer(channel),
+          samplesThisTime,
+          voice.envelope,
+          endEnvelope
+        );
+      }
+
+      voice.envelope = endEnvelope;
+      voice.active = endEnvelope > 0;
+    }
+
+    voice.position += samplesThisTime;
+    done += samplesThisTime;
+  }
+}
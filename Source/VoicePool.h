@@ -0,0 +1,194 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <atomic>
+#include <vector>
+
+#include "RenderedSample.h"
+#include "TranspositionCache.h"
+
+/**
+ * Fixed set of voices playing the rendered sample, so that overlapping
+ * triggers don't cut each other off.
+ *
+ * Everything is allocated in prepare. Triggers, stealing and rendering only
+ * touch preallocated state and are meant to be called from the audio thread.
+ */
+class VoicePool {
+  public:
+    static constexpr int numVoices = 32;
+
+    /**
+     * Stolen voices fading out, the quietest is cut short when all are busy
+     */
+    static constexpr int numTails = 8;
+
+    /**
+     * Gain of a voice at full velocity, the headroom playback always had
+     */
+    static constexpr float headroom = 0.9f;
+
+    /**
+     * Note playing the render at its original pitch
+     */
+    static constexpr int rootNote = 60;
+
+    /**
+     * Length of the fade after a note off
+     */
+    static constexpr double releaseSeconds = 0.03;
+
+    VoicePool () = default;
+
+    /**
+     * Allocate the voices, their tails and the scratch space for releasing
+     * voices
+     *
+     * @param numChannels
+     * @param maximumBlockSize
+     * @param sampleRate
+     * @param loopIn Whether voices restart at the end of the mix, and an
+     *               automatic voice plays while no note does and the
+     *               transport rolls. The first note on takes over the
+     *               automatic voice.
+     */
+    void prepare (int numChannels, int maximumBlockSize, double sampleRate, bool loopIn);
+
+    /**
+     * Start the automatic loop voice while the transport rolls, release it
+     * when it stops
+     *
+     * @param playing
+     */
+    void setTransportPlaying (bool playing) { this->transportPlaying = playing; }
+
+    /**
+     * Silence every voice
+     */
+    void reset ();
+
+    /**
+     * Start a voice. In loop mode the automatic voice is retriggered first,
+     * otherwise a free voice is used or the oldest one is stolen. What a
+     * retriggered or stolen voice was playing fades out with the release.
+     *
+     * @param note Transposes the voice relative to rootNote, negative values
+     *             play at the original pitch
+     * @param velocity Gain of the voice, from 0 to 1
+     */
+    void noteOn (int note, float velocity);
+
+    /**
+     * Release every voice started by the note
+     *
+     * @param note
+     */
+    void noteOff (int note);
+
+    void allNotesOff ();
+
+    /**
+     * Add every playing voice to a span of the buffer
+     *
+     * @param buffer
+     * @param startSample
+     * @param numSamples
+     * @param rendered
+     * @param timeOffset Time offset parameter value in milliseconds
+     * @param transpositions Transposed voices play the original pitch while
+     *                       their transposition is missing or if nullptr
+     */
+    void render (
+      juce::AudioBuffer<float> &buffer,
+      int startSample,
+      int numSamples,
+      const RenderedSample &rendered,
+      int timeOffset,
+      TranspositionCache *transpositions = nullptr
+    );
+
+    int getNumActiveVoices () const;
+
+    /**
+     * @return The number of playing voices started by a note, the
+     *         automatic loop voice excluded
+     */
+    int getNumTriggeredVoices () const;
+
+    /**
+     * @return The read position of the most recently started voice still
+     *         playing, safe to call from any thread
+     */
+    int getPosition () const { return this->position.load(); }
+
+  private:
+    struct Voice {
+      bool active = false;
+      bool releasing = false;
+
+      /**
+       * Started by render in loop mode rather than by a note
+       */
+      bool automatic = false;
+      int note = -1;
+      int semitones = 0;
+      int position = 0;
+      float gain = 0;
+
+      /**
+       * Release envelope level, from 1 down to 0
+       */
+      float envelope = 1;
+
+      /**
+       * Trigger counter value when the voice started, the lowest is stolen
+       */
+      juce::uint64 startedAt = 0;
+    };
+
+    std::vector<Voice> voices;
+
+    /**
+     * Releasing copies of the voices noteOn reused
+     */
+    std::vector<Voice> tails;
+
+    /**
+     * Holds releasing voices before their envelope is applied
+     */
+    juce::AudioBuffer<float> scratch;
+
+    float releaseStep = 1;
+
+    bool loop = false;
+    bool transportPlaying = true;
+
+    juce::uint64 numTriggers = 0;
+
+    std::atomic<int> position{0};
+
+    /**
+     * Render a voice from its transposition when there is one
+     */
+    void renderVoice (
+      Voice &voice,
+      juce::AudioBuffer<float> &buffer,
+      int startSample,
+      int numSamples,
+      const RenderedSample &rendered,
+      int timeOffset,
+      TranspositionCache *transpositions
+    );
+
+    void renderVoice (
+      Voice &voice,
+      juce::AudioBuffer<float> &buffer,
+      int startSample,
+      int numSamples,
+      const RenderedSample &rendered,
+      int timeOffset
+    );
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VoicePool)
+};
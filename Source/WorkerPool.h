@@ -0,0 +1,79 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+/**
+ * Thread pool shared by every plugin instance in the process
+ */
+class WorkerPool {
+  public:
+    /**
+     * Run a task once for every index in [0, numTasks) and return when all
+     * of them have finished.
+     *
+     * The calling thread works through the tasks as well, so nested calls
+     * from inside a task keep making progress even when the pool is busy.
+     *
+     * @param numTasks
+     * @param task
+     */
+    void parallelFor (int numTasks, const std::function<void (int)> &task) {
+      if (numTasks <= 0) {
+        return;
+      }
+
+      if (numTasks == 1) {
+        task(0);
+        return;
+      }
+
+      auto batch = std::make_shared<Batch>(numTasks, task);
+      int numHelpers = juce::jmin(numTasks - 1, this->pool->getNumThreads());
+
+      for (int i = 0; i < numHelpers; i++) {
+        this->pool->addJob([batch] () { batch->work(); });
+      }
+
+      batch->work();
+      batch->finished.wait(-1);
+    }
+
+    int getNumThreads () const {
+      return this->pool->getNumThreads();
+    }
+
+  private:
+    struct Batch {
+      Batch (int numTasksIn, const std::function<void (int)> &taskIn) :
+        numTasks(numTasksIn),
+        task(taskIn) {
+      }
+
+      /**
+       * Claim and run tasks until none are left. Helpers starting after the
+       * batch has finished find nothing to claim and never touch the task.
+       */
+      void work () {
+        for (int index = this->next++; index < this->numTasks; index = this->next++) {
+          this->task(index);
+
+          if (++this->numFinished == this->numTasks) {
+            this->finished.signal();
+          }
+        }
+      }
+
+      const int numTasks;
+      const std::function<void (int)> &task;
+
+      std::atomic<int> next{0};
+      std::atomic<int> numFinished{0};
+      juce::WaitableEvent finished{true};
+    };
+
+    juce::SharedResourcePointer<juce::ThreadPool> pool;
+};
@@ -0,0 +1,194 @@
+#include <AudioBufferUtils.h>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+namespace {
+  /**
+   * The scalar trim the block scans replaced, comparing magnitudes
+   */
+  juce::AudioBuffer<float> scalarTrim (const juce::AudioBuffer<float> &buffer, float threshold) {
+    int numSamples = buffer.getNumSamples();
+    int first = numSamples;
+    int last = -1;
+
+    for (int i = 0; i < numSamples; i++) {
+      for (int channel = 0; channel < buffer.getNumChannels(); channel++) {
+        if (std::abs(buffer.getSample(channel, i)) > threshold) {
+          first = juce::jmin(first, i);
+          last = i;
+        }
+      }
+    }
+
+    juce::AudioBuffer<float> trimmed;
+    trimmed.makeCopyOf(buffer);
+
+    if (last < 0) {
+      return trimmed;
+    }
+
+    trimmed.setSize(buffer.getNumChannels(), last + 1 - first);
+    for (int channel = 0; channel < buffer.getNumChannels(); channel++) {
+      trimmed.copyFrom(channel, 0, buffer, channel, first, last + 1 - first);
+    }
+
+    return trimmed;
+  }
+
+  float scalarPeak (const juce::AudioBuffer<float> &buffer) {
+    float peak = 0;
+
+    for (int channel = 0; channel < buffer.getNumChannels(); channel++) {
+      for (int i = 0; i < buffer.getNumSamples(); i++) {
+        peak = juce::jmax(peak, std::abs(buffer.getSample(channel, i)));
+      }
+    }
+
+    return peak;
+  }
+
+  void requireEqual (const juce::AudioBuffer<float> &actual, const juce::AudioBuffer<float> &expected) {
+    REQUIRE(actual.getNumChannels() == expected.getNumChannels());
+    REQUIRE(actual.getNumSamples() == expected.getNumSamples());
+
+    for (int channel = 0; channel < expected.getNumChannels(); channel++) {
+      for (int i = 0; i < expected.getNumSamples(); i++) {
+        REQUIRE(actual.getSample(channel, i) == expected.getSample(channel, i));
+      }
+    }
+  }
+
+  /**
+   * Noise between the given samples, silence around it, with the channels
+   * starting and ending at different places
+   */
+  juce::AudioBuffer<float> makePadded (int numSamples, int loudStart, int loudEnd, juce::Random &random) {
+    juce::AudioBuffer<float> buffer(2, numSamples);
+    buffer.clear();
+
+    for (int i = loudStart; i < loudEnd; i++) {
+      buffer.setSample(0, i, random.nextFloat() * 2.0f - 1.0f);
+    }
+
+    // Quieter than the threshold, trim has to look past it
+    for (int i = 0; i < numSamples; i++) {
+      buffer.setSample(1, i, 0.00005f);
+    }
+    buffer.setSample(1, (loudStart + loudEnd) / 2, -0.5f);
+
+    return buffer;
+  }
+}
+
+TEST_CASE("Trim matches a per-sample scan across block boundaries", "[utils]")
+{
+  juce::Random random(7);
+  const int block = AudioBufferUtils::scanBlockSize;
+
+  for (int numSamples: {2, block - 1, block, block + 1, 4 * block + 3}) {
+    for (int loudStart: {0, 1, block - 1, block, block + 1}) {
+      for (int loudEnd: {loudStart + 1, 2 * block, 3 * block + 1, numSamples}) {
+        if (loudStart >= numSamples || loudEnd > numSamples || loudEnd <= loudStart) {
+          continue;
+        }
+
+        juce::AudioBuffer<float> buffer = makePadded(numSamples, loudStart, loudEnd, random);
+        juce::AudioBuffer<float> expected = scalarTrim(buffer, 0.0001f);
+
+        AudioBufferUtils::trim(buffer);
+        requireEqual(buffer, expected);
+      }
+    }
+  }
+}
+
+TEST_CASE("Trim keeps negative-only peaks", "[utils]")
+{
+  juce::AudioBuffer<float> buffer(1, 1000);
+  buffer.clear();
+  buffer.setSample(0, 300, -0.5f);
+  buffer.setSample(0, 700, -0.25f);
+
+  juce::AudioBuffer<float> expected = scalarTrim(buffer, 0.0001f);
+  AudioBufferUtils::trim(buffer);
+
+  requireEqual(buffer, expected);
+  REQUIRE(buffer.getNumSamples() == 401);
+  REQUIRE(buffer.getSample(0, 0) == -0.5f);
+  REQUIRE(buffer.getSample(0, 400) == -0.25f);
+}
+
+TEST_CASE("Normalize matches the per-sample peak", "[utils]")
+{
+  juce::Random random(11);
+  juce::AudioBuffer<float> buffer(2, 1000);
+
+  for (int channel = 0; channel < 2; channel++) {
+    for (int i = 0; i < 1000; i++) {
+      buffer.setSample(channel, i, (random.nextFloat() - 0.5f) * 0.5f);
+    }
+  }
+
+  // The loudest sample is negative
+  buffer.setSample(1, 613, -0.8f);
+
+  juce::AudioBuffer<float> original;
+  original.makeCopyOf(buffer);
+  float gain = 1.0f / scalarPeak(original);
+
+  AudioBufferUtils::normalize(buffer);
+
+  REQUIRE_THAT(buffer.getSample(1, 613), Catch::Matchers::WithinAbs(-1.0, 0.00001));
+  for (int channel = 0; channel < 2; channel++) {
+    for (int i = 0; i < 1000; i++) {
+      REQUIRE_THAT(buffer.getSample(channel, i), Catch::Matchers::WithinAbs(original.getSample(channel, i) * gain, 0.00001));
+    }
+  }
+}
+
+TEST_CASE("Silent buffers are left untouched", "[utils]")
+{
+  for (float level: {0.0f, 0.00005f, -0.00005f}) {
+    juce::AudioBuffer<float> buffer(2, 600);
+    for (int channel = 0; channel < 2; channel++) {
+      for (int i = 0; i < 600; i++) {
+        buffer.setSample(channel, i, level);
+      }
+    }
+
+    juce::AudioBuffer<float> original;
+    original.makeCopyOf(buffer);
+
+    AudioBufferUtils::trim(buffer);
+    requireEqual(buffer, original);
+
+    // Below the threshold is not silence to normalize
+    if (level == 0.0f) {
+      AudioBufferUtils::normalize(buffer);
+      requireEqual(buffer, original);
+    }
+  }
+}
+
+TEST_CASE("Single-sample buffers", "[utils]")
+{
+  for (float value: {0.5f, -0.5f}) {
+    juce::AudioBuffer<float> buffer(1, 1);
+    buffer.setSample(0, 0, value);
+
+    AudioBufferUtils::trim(buffer);
+    REQUIRE(buffer.getNumSamples() == 1);
+    REQUIRE(buffer.getSample(0, 0) == value);
+
+    AudioBufferUtils::normalize(buffer);
+    REQUIRE(buffer.getSample(0, 0) == (value > 0 ? 1.0f : -1.0f));
+  }
+
+  juce::AudioBuffer<float> silent(1, 1);
+  silent.clear();
+
+  AudioBufferUtils::trim(silent);
+  AudioBufferUtils::normalize(silent);
+  REQUIRE(silent.getNumSamples() == 1);
+  REQUIRE(silent.getSample(0, 0) == 0.0f);
+}
@@ -0,0 +1,71 @@
+#include <DeadlineMonitor.h>
+#include <PluginProcessor.h>
+#include <juce_events/juce_events.h>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+TEST_CASE("Blocks are measured against their budget", "[deadline]")
+{
+  DeadlineMonitor monitor;
+  monitor.prepare(48000);
+
+  // 64 samples at 48 kHz leave 1.333 ms
+  monitor.addBlock(0.0001, 64);
+  monitor.addBlock(0.0001, 64);
+  monitor.addBlock(0.0007, 64);
+  monitor.addBlock(0.0021, 64);
+
+  auto statistics = monitor.getStatistics();
+  REQUIRE(statistics.numBlocks == 4);
+  REQUIRE(statistics.numOverruns == 1);
+  REQUIRE(statistics.histogram[0] == 2);
+  REQUIRE(statistics.histogram[5] == 1);
+  REQUIRE(statistics.histogram[DeadlineMonitor::numBuckets - 5] == 1);
+  REQUIRE_THAT(statistics.worstLoad, Catch::Matchers::WithinRel(1.575, 0.001));
+  REQUIRE_THAT(statistics.worstMs, Catch::Matchers::WithinRel(2.1, 0.001));
+  REQUIRE_THAT(statistics.getLoadPercentile(0.5), Catch::Matchers::WithinAbs(0.1, 0.0001));
+  REQUIRE_THAT(statistics.getLoadPercentile(0.75), Catch::Matchers::WithinAbs(0.6, 0.0001));
+
+  // Applied by the audio thread on its next block
+  monitor.reset();
+  monitor.addBlock(0.0001, 64);
+  REQUIRE(monitor.getStatistics().numBlocks == 1);
+  REQUIRE(monitor.getStatistics().numOverruns == 0);
+}
+
+// Wall clock bound, hidden from the default run so loaded machines and Debug
+// builds don't fail it. Run it with: Tests "[deadline]"
+TEST_CASE("Playback stays well under budget at 64 samples", "[.][deadline]")
+{
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+  PluginProcessor processor;
+  processor.setRateAndBufferSizeDetails(48000, 64);
+  processor.prepareToPlay(48000, 64);
+
+  juce::AudioBuffer<float> sample(2, 48000);
+  for (int channel = 0; channel < sample.getNumChannels(); channel++) {
+    for (int i = 0; i < sample.getNumSamples(); i++) {
+      sample.setSample(channel, i, std::sin((float) i * 0.01f) * 0.5f);
+    }
+  }
+  processor.newSampleLoaded(sample);
+
+  // Playback only starts once the render thread published a render
+  for (int waited = 0; processor.getNumSamples() <= 0 && waited < 60000; waited += 10) {
+    juce::Thread::sleep(10);
+  }
+  REQUIRE(processor.getNumSamples() > 0);
+
+  juce::AudioBuffer<float> buffer(2, 64);
+  juce::MidiBuffer midi;
+
+  processor.getDeadlineMonitor().reset();
+  for (int block = 0; block < 48000 / 64; block++) {
+    processor.processBlock(buffer, midi);
+  }
+
+  auto statistics = processor.getDeadlineMonitor().getStatistics();
+  REQUIRE(statistics.numBlocks == 48000 / 64);
+  REQUIRE(statistics.getLoadPercentile(0.99) <= 0.5);
+}
@@ -0,0 +1,46 @@
+#include <FeedbackDelay.h>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+TEST_CASE("Feedback delay matches the sum of its echoes", "[delay]")
+{
+  const int numSamples = 1000;
+  const int delayTime = 300;
+  const float mix = 0.5f;
+  const float feedback = 0.6f;
+
+  juce::AudioBuffer<float> buffer(2, numSamples);
+  for (int channel = 0; channel < buffer.getNumChannels(); channel++) {
+    for (int i = 0; i < numSamples; i++) {
+      buffer.setSample(channel, i, std::sin((float) i * 0.01f * (float) (channel + 1)));
+    }
+  }
+
+  juce::AudioBuffer<float> dry;
+  dry.makeCopyOf(buffer);
+
+  int numEchoes = FeedbackDelay::getNumEchoes(dry.getMagnitude(0, numSamples), mix, feedback);
+  FeedbackDelay::render(buffer, mix, feedback, delayTime);
+
+  REQUIRE(buffer.getNumSamples() == numSamples + numEchoes * delayTime);
+
+  // Echoes past the last rendered one are below the threshold, so the
+  // naive sum of the rendered echoes must match within it
+  juce::AudioBuffer<float> expected(2, buffer.getNumSamples());
+  expected.clear();
+  for (int channel = 0; channel < expected.getNumChannels(); channel++) {
+    expected.copyFrom(channel, 0, dry, channel, 0, numSamples);
+
+    float gain = mix;
+    for (int echo = 1; echo <= numEchoes; echo++) {
+      gain *= feedback;
+      expected.addFrom(channel, echo * delayTime, dry, channel, 0, numSamples, gain);
+    }
+  }
+
+  for (int channel = 0; channel < expected.getNumChannels(); channel++) {
+    for (int i = 0; i < expected.getNumSamples(); i++) {
+      REQUIRE_THAT(buffer.getSample(channel, i), Catch::Matchers::WithinAbs(expected.getSample(channel, i), 0.002));
+    }
+  }
+}
@@ -0,0 +1,68 @@
+#include <PeakPyramid.h>
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+  juce::Range<float> exactRange (const juce::AudioBuffer<float> &signal, int channel, int start, int end) {
+    return juce::FloatVectorOperations::findMinAndMax(signal.getReadPointer(channel, start), end - start);
+  }
+}
+
+TEST_CASE("Peaks cover every span of the signal", "[thumbnail]")
+{
+  const int numSamples = 100000;
+
+  juce::AudioBuffer<float> signal(2, numSamples);
+  juce::Random random(42);
+  for (int channel = 0; channel < signal.getNumChannels(); channel++) {
+    for (int i = 0; i < numSamples; i++) {
+      signal.setSample(channel, i, random.nextFloat() * 2.0f - 1.0f);
+    }
+  }
+
+  // Added in uneven chunks, as the render thread does
+  PeakPyramid peaks(2, numSamples, 48000);
+  juce::AudioBuffer<float> chunk(2, 777);
+  for (int start = 0; start < numSamples; start += chunk.getNumSamples()) {
+    int length = juce::jmin(chunk.getNumSamples(), numSamples - start);
+    for (int channel = 0; channel < 2; channel++) {
+      chunk.copyFrom(channel, 0, signal, channel, start, length);
+    }
+    peaks.addBlock(chunk, length);
+  }
+  peaks.finish();
+
+  REQUIRE(peaks.getNumLevels() > 1);
+
+  SECTION("Spans aligned to entries are exact") {
+    for (int channel = 0; channel < 2; channel++) {
+      for (int start = 0; start + 4096 <= numSamples; start += 4096) {
+        REQUIRE(peaks.getRange(channel, start, start + 4096) == exactRange(signal, channel, start, start + 4096));
+      }
+    }
+  }
+
+  SECTION("Other spans are never narrower than exact") {
+    for (int channel = 0; channel < 2; channel++) {
+      for (int start = 13; start + 1000 <= numSamples; start += 1531) {
+        auto range = peaks.getRange(channel, start, start + 1000);
+        auto exact = exactRange(signal, channel, start, start + 1000);
+        REQUIRE(range.getStart() <= exact.getStart());
+        REQUIRE(range.getEnd() >= exact.getEnd());
+      }
+    }
+  }
+
+  SECTION("Peaks survive a round trip through a stream") {
+    juce::MemoryOutputStream output;
+    peaks.writeTo(output);
+
+    juce::MemoryInputStream input(output.getData(), output.getDataSize(), false);
+    auto restored = PeakPyramid::readFrom(input);
+
+    REQUIRE(restored != nullptr);
+    REQUIRE(restored->getNumChannels() == 2);
+    REQUIRE(restored->getNumSamples() == numSamples);
+    REQUIRE(restored->getNumLevels() == peaks.getNumLevels());
+    REQUIRE(restored->getRange(1, 12345, 67890) == peaks.getRange(1, 12345, 67890));
+  }
+}
@@ -0,0 +1,50 @@
+#include <RenderProfiler.h>
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("Profiles keep the stages of the latest renders", "[profiling]")
+{
+  RenderProfiler profiler;
+
+  for (int render = 0; render < 5; render++) {
+    profiler.beginProfile();
+
+    // Stages of one render run on several threads at once
+    juce::Thread::launch([&profiler] () { RenderProfiler::ScopedTimer timer(&profiler, "rise reverb"); });
+    juce::Thread::launch([&profiler] () { RenderProfiler::ScopedTimer timer(&profiler, "fall reverb"); });
+    profiler.record("render", 0, 1);
+
+    // Launched threads are detached, wait for their records
+    while (profiler.getEvents(1).size() < 3) {
+      juce::Thread::sleep(1);
+    }
+  }
+
+  auto events = profiler.getEvents(2);
+  REQUIRE(events.size() == 6);
+
+  for (const auto &event: events) {
+    REQUIRE(event.profile >= 4);
+    REQUIRE(event.endMs >= event.startMs);
+  }
+
+  juce::var trace = juce::JSON::parse(RenderProfiler::toChromeTrace(events));
+  REQUIRE(trace["traceEvents"].size() == 6);
+  REQUIRE(trace["traceEvents"][0]["ph"].toString() == "X");
+}
+
+TEST_CASE("Old records are overwritten", "[profiling]")
+{
+  RenderProfiler profiler;
+
+  for (int render = 0; render < 3; render++) {
+    profiler.beginProfile();
+
+    for (int i = 0; i < RenderProfiler::capacity; i++) {
+      profiler.record("stage", i, i + 1);
+    }
+  }
+
+  auto events = profiler.getEvents(10);
+  REQUIRE(events.size() == RenderProfiler::capacity);
+  REQUIRE(events.front().profile == 3);
+}
@@ -0,0 +1,53 @@
+#include <RenderedSample.h>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+static juce::AudioBuffer<float> makeTone (int numSamples, float frequency) {
+  juce::AudioBuffer<float> buffer(2, numSamples);
+  for (int channel = 0; channel < buffer.getNumChannels(); channel++) {
+    for (int i = 0; i < numSamples; i++) {
+      buffer.setSample(channel, i, std::sin((float) i * frequency));
+    }
+  }
+
+  return buffer;
+}
+
+TEST_CASE("Mixing at playback matches a concatenated render", "[mix]")
+{
+  const double sampleRate = 1000;
+  const int timeOffset = GENERATE(-300, -20, 0, 150);
+
+  auto rise = makeTone(800, 0.03f);
+  auto fall = makeTone(600, 0.07f);
+
+  // Concatenate, normalize and fade the way a single buffer render would
+  int fallStart = juce::jmax(0, rise.getNumSamples() + timeOffset);
+  int numSamples = juce::jmax(rise.getNumSamples(), fallStart + fall.getNumSamples());
+  juce::AudioBuffer<float> expected(2, numSamples);
+  expected.clear();
+  for (int channel = 0; channel < expected.getNumChannels(); channel++) {
+    expected.addFrom(channel, 0, rise, channel, 0, rise.getNumSamples());
+    expected.addFrom(channel, fallStart, fall, channel, 0, fall.getNumSamples());
+  }
+  expected.applyGain(1.0f / juce::jmax(1.0f, expected.getMagnitude(0, numSamples)));
+  int fades = (int) (numSamples * 0.1);
+  expected.applyGainRamp(0, fades, 0, 1);
+  expected.applyGainRamp(numSamples - fades, fades, 1, 0);
+
+  RenderedSample rendered(std::move(rise), std::move(fall), sampleRate);
+  REQUIRE(rendered.getNumSamples(timeOffset) == numSamples);
+
+  // Odd block sizes cross the fade boundaries and the start of the fall
+  juce::AudioBuffer<float> played(2, numSamples);
+  played.clear();
+  for (int start = 0; start < numSamples; start += 77) {
+    rendered.addTo(played, start, start, juce::jmin(77, numSamples - start), timeOffset, 1.0f);
+  }
+
+  for (int channel = 0; channel < expected.getNumChannels(); channel++) {
+    for (int i = 0; i < numSamples; i++) {
+      REQUIRE_THAT(played.getSample(channel, i), Catch::Matchers::WithinAbs(expected.getSample(channel, i), 0.0001));
+    }
+  }
+}
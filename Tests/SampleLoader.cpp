@@ -0,0 +1,47 @@
+#include <SampleLoader.h>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+TEST_CASE("Files longer than a chunk load completely", "[loading]")
+{
+  const int numSamples = SampleLoader::chunkSize * 2 + 123;
+
+  juce::AudioBuffer<float> source(2, numSamples);
+  for (int channel = 0; channel < source.getNumChannels(); channel++) {
+    for (int i = 0; i < numSamples; i++) {
+      source.setSample(channel, i, std::sin((float) i * 0.001f * (float) (channel + 1)) * 0.5f);
+    }
+  }
+
+  juce::TemporaryFile temporaryFile(".wav");
+  {
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(
+      temporaryFile.getFile().createOutputStream().release(),
+      48000,
+      2,
+      32,
+      {},
+      0
+    ));
+    REQUIRE(writer != nullptr);
+    REQUIRE(writer->writeFromAudioSampleBuffer(source, 0, numSamples));
+  }
+
+  juce::AudioFormatManager formatManager;
+  formatManager.registerBasicFormats();
+
+  auto reader = SampleLoader::createReader(formatManager, temporaryFile.getFile());
+  REQUIRE(dynamic_cast<juce::MemoryMappedAudioFormatReader *>(reader.get()) != nullptr);
+
+  juce::AudioBuffer<float> sample;
+  REQUIRE(SampleLoader::read(*reader, sample).isEmpty());
+  REQUIRE(sample.getNumChannels() == 2);
+  REQUIRE(sample.getNumSamples() == numSamples);
+
+  for (int channel = 0; channel < sample.getNumChannels(); channel++) {
+    for (int i = 0; i < numSamples; i += 997) {
+      REQUIRE_THAT(sample.getSample(channel, i), Catch::Matchers::WithinAbs(source.getSample(channel, i), 0.00001));
+    }
+  }
+}
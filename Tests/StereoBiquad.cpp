@@ -0,0 +1,59 @@
+#include <StereoBiquad.h>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+TEST_CASE("Stereo biquad matches one IIRFilter per channel", "[filter]")
+{
+  auto coefficients = juce::IIRCoefficients::makeLowPass(48000, 800, 2.0);
+
+  juce::AudioBuffer<float> buffer(2, 2000);
+  for (int channel = 0; channel < buffer.getNumChannels(); channel++) {
+    for (int i = 0; i < buffer.getNumSamples(); i++) {
+      buffer.setSample(channel, i, std::sin((float) i * 0.3f * (float) (channel + 1)));
+    }
+  }
+
+  juce::AudioBuffer<float> expected;
+  expected.makeCopyOf(buffer);
+  for (int channel = 0; channel < expected.getNumChannels(); channel++) {
+    juce::IIRFilter filter;
+    filter.setCoefficients(coefficients);
+    filter.processSamples(expected.getWritePointer(channel), expected.getNumSamples());
+  }
+
+  // Split in two to check that the state carries over
+  StereoBiquad biquad;
+  biquad.setCoefficients(coefficients);
+  biquad.process(buffer, 0, 700);
+  biquad.process(buffer, 700, 1300);
+
+  for (int channel = 0; channel < buffer.getNumChannels(); channel++) {
+    for (int i = 0; i < buffer.getNumSamples(); i++) {
+      REQUIRE_THAT(buffer.getSample(channel, i), Catch::Matchers::WithinAbs(expected.getSample(channel, i), 0.0001));
+    }
+  }
+}
+
+TEST_CASE("Batch design matches IIRCoefficients", "[filter]")
+{
+  const double sampleRate = 44100;
+  const float frequencies[] = {20.0f, 200.0f, 2000.0f, 15000.0f, 20000.0f};
+  const float resonances[] = {0.1f, 0.7f, 1.0f, 5.0f, 10.0f};
+
+  for (bool highPass: {false, true}) {
+    StereoBiquad::Coefficients designed[5];
+    StereoBiquad::design(highPass, sampleRate, frequencies, resonances, 5, designed);
+
+    for (int i = 0; i < 5; i++) {
+      auto expected = highPass
+                      ? juce::IIRCoefficients::makeHighPass(sampleRate, frequencies[i], resonances[i])
+                      : juce::IIRCoefficients::makeLowPass(sampleRate, frequencies[i], resonances[i]);
+      const float actual[] = {designed[i].b0, designed[i].b1, designed[i].b2, designed[i].a1, designed[i].a2};
+
+      for (int k = 0; k < 5; k++) {
+        float tolerance = 0.001f * std::abs(expected.coefficients[k]) + 1e-7f;
+        REQUIRE_THAT(actual[k], Catch::Matchers::WithinAbs(expected.coefficients[k], tolerance));
+      }
+    }
+  }
+}
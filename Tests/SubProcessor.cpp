@@ -0,0 +1,39 @@
+#include <SubProcessor.h>
+#include <juce_events/juce_events.h>
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("Back-to-back renders skip preparation", "[prepare]")
+{
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+  // Any concrete processor can host the parameters
+  juce::AudioProcessorGraph host;
+  GUIParams parameters(host);
+
+  juce::AudioBuffer<float> source(2, 4800);
+  for (int channel = 0; channel < source.getNumChannels(); channel++) {
+    for (int i = 0; i < source.getNumSamples(); i++) {
+      source.setSample(channel, i, std::sin((float) i * 0.05f));
+    }
+  }
+
+  juce::AudioBuffer<float> buffer;
+  SubProcessor subProcessor(RISE, buffer, parameters);
+
+  auto render = [&] () {
+    buffer.makeCopyOf(source);
+    subProcessor.prepareToPlay(48000, 120);
+    subProcessor.prepareReverb(0);
+    subProcessor.process(1);
+  };
+
+  render();
+  int numPreparations = subProcessor.getNumPreparations();
+  REQUIRE(numPreparations == 2);
+
+  render();
+  REQUIRE(subProcessor.getNumPreparations() == numPreparations);
+
+  subProcessor.prepareToPlay(44100, 120);
+  REQUIRE(subProcessor.getNumPreparations() == numPreparations + 1);
+}
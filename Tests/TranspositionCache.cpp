@@ -0,0 +1,81 @@
+#include <TranspositionCache.h>
+#include <catch2/catch_test_macros.hpp>
+
+static RenderedSample makeRenderedSample () {
+  juce::AudioBuffer<float> rise(2, 4800);
+  juce::AudioBuffer<float> fall(2, 2400);
+  for (int channel = 0; channel < 2; channel++) {
+    for (int i = 0; i < rise.getNumSamples(); i++) {
+      rise.setSample(channel, i, std::sin((float) i * 0.05f));
+    }
+    for (int i = 0; i < fall.getNumSamples(); i++) {
+      fall.setSample(channel, i, std::sin((float) i * 0.02f));
+    }
+  }
+
+  return RenderedSample(std::move(rise), std::move(fall), 48000);
+}
+
+TEST_CASE("Transpositions are built on request and keep the length", "[transpositions]")
+{
+  auto base = makeRenderedSample();
+  TranspositionCache cache;
+
+  cache.beginBlock();
+  REQUIRE(cache.get(7) == nullptr);
+  cache.endBlock();
+
+  REQUIRE(cache.buildNext(base));
+  REQUIRE_FALSE(cache.buildNext(base));
+
+  cache.beginBlock();
+  const RenderedSample *transposition = cache.get(7);
+  cache.endBlock();
+
+  REQUIRE(transposition != nullptr);
+  REQUIRE(transposition->getNumSamples(0) == base.getNumSamples(0));
+  REQUIRE(transposition->getNumSamples(-500) == base.getNumSamples(-500));
+}
+
+TEST_CASE("The least recently used transposition is evicted over budget", "[transpositions]")
+{
+  auto base = makeRenderedSample();
+  size_t numBytes = (size_t) (4800 + 2400) * 2 * sizeof(float);
+  TranspositionCache cache(numBytes * 2);
+
+  for (int semitones: {1, 2, 3}) {
+    cache.beginBlock();
+    cache.get(semitones);
+    cache.endBlock();
+    REQUIRE(cache.buildNext(base));
+  }
+
+  REQUIRE(cache.getMemoryUsage() == numBytes * 2);
+
+  cache.beginBlock();
+  REQUIRE(cache.get(1) == nullptr);
+  REQUIRE(cache.get(2) != nullptr);
+  REQUIRE(cache.get(3) != nullptr);
+  cache.endBlock();
+}
+
+TEST_CASE("Only the first lookup of a missing transposition wakes the builder", "[transpositions]")
+{
+  auto base = makeRenderedSample();
+  int numWakeUps = 0;
+  TranspositionCache cache(TranspositionCache::sharedMemoryBudget, [&numWakeUps] () { numWakeUps++; });
+
+  for (int block = 0; block < 3; block++) {
+    cache.beginBlock();
+    cache.get(5);
+    cache.endBlock();
+  }
+  REQUIRE(numWakeUps == 1);
+
+  REQUIRE(cache.buildNext(base));
+
+  cache.beginBlock();
+  REQUIRE(cache.get(5) != nullptr);
+  cache.endBlock();
+  REQUIRE(numWakeUps == 1);
+}
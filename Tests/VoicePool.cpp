@@ -0,0 +1,168 @@
+#include <VoicePool.h>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+static RenderedSample makeRenderedSample () {
+  juce::AudioBuffer<float> rise(1, 1000);
+  juce::AudioBuffer<float> fall(1, 1000);
+  for (int i = 0; i < 1000; i++) {
+    rise.setSample(0, i, std::sin((float) i * 0.05f));
+    fall.setSample(0, i, std::sin((float) i * 0.02f));
+  }
+
+  return RenderedSample(std::move(rise), std::move(fall), 1000);
+}
+
+TEST_CASE("Overlapping triggers keep playing", "[voices]")
+{
+  auto rendered = makeRenderedSample();
+  const int timeOffset = 0;
+
+  VoicePool voices;
+  voices.prepare(1, 64, 1000, false);
+
+  juce::AudioBuffer<float> played(1, 700);
+  played.clear();
+  voices.noteOn(60, 1.0f);
+  voices.render(played, 0, 300, rendered, timeOffset);
+  voices.noteOn(62, 0.5f);
+  voices.render(played, 300, 400, rendered, timeOffset);
+
+  REQUIRE(voices.getNumActiveVoices() == 2);
+
+  juce::AudioBuffer<float> first(1, 700);
+  juce::AudioBuffer<float> second(1, 400);
+  first.clear();
+  second.clear();
+  rendered.addTo(first, 0, 0, 700, timeOffset, VoicePool::headroom);
+  rendered.addTo(second, 0, 0, 400, timeOffset, 0.5f * VoicePool::headroom);
+
+  for (int i = 0; i < 700; i++) {
+    float expected = first.getSample(0, i) + (i >= 300 ? second.getSample(0, i - 300) : 0.0f);
+    REQUIRE_THAT(played.getSample(0, i), Catch::Matchers::WithinAbs(expected, 0.0001));
+  }
+}
+
+TEST_CASE("The oldest voice is stolen once all are playing", "[voices]")
+{
+  auto rendered = makeRenderedSample();
+
+  VoicePool voices;
+  voices.prepare(1, 64, 1000, false);
+
+  juce::AudioBuffer<float> block(1, 10);
+  for (int note = 0; note <= VoicePool::numVoices; note++) {
+    voices.noteOn(note, 1.0f);
+    voices.render(block, 0, 10, rendered, 0);
+  }
+
+  REQUIRE(voices.getNumActiveVoices() == VoicePool::numVoices);
+
+  // The newest voice started 10 samples ago, the stolen one restarted with it
+  REQUIRE(voices.getPosition() == 10);
+
+  // Releasing the first note finds no voice left playing it
+  voices.noteOff(0);
+  voices.render(block, 0, 10, rendered, 0);
+  REQUIRE(voices.getNumActiveVoices() == VoicePool::numVoices);
+
+  voices.allNotesOff();
+  for (int i = 0; i < 10; i++) {
+    voices.render(block, 0, 10, rendered, 0);
+  }
+  REQUIRE(voices.getNumActiveVoices() == 0);
+}
+
+TEST_CASE("A note on restarts the automatic loop voice", "[voices]")
+{
+  auto rendered = makeRenderedSample();
+  const int length = rendered.getNumSamples(0);
+
+  VoicePool voices;
+  voices.prepare(1, 64, 1000, true);
+
+  juce::AudioBuffer<float> block(1, 100);
+  voices.render(block, 0, 100, rendered, 0);
+  REQUIRE(voices.getNumActiveVoices() == 1);
+  REQUIRE(voices.getNumTriggeredVoices() == 0);
+  REQUIRE(voices.getPosition() == 100);
+
+  // The note takes over the loop from its start instead of adding a voice
+  voices.noteOn(60, 1.0f);
+  voices.render(block, 0, 100, rendered, 0);
+  REQUIRE(voices.getNumActiveVoices() == 1);
+  REQUIRE(voices.getNumTriggeredVoices() == 1);
+  REQUIRE(voices.getPosition() == 100);
+
+  // Played through its end, the note's voice loops until its note off
+  for (int played = 100; played < length; played += 100) {
+    voices.render(block, 0, 100, rendered, 0);
+  }
+  REQUIRE(voices.getNumTriggeredVoices() == 1);
+
+  voices.noteOff(60);
+  for (int i = 0; i < 10; i++) {
+    voices.render(block, 0, 100, rendered, 0);
+  }
+  REQUIRE(voices.getNumTriggeredVoices() == 0);
+  REQUIRE(voices.getNumActiveVoices() == 1);
+}
+
+TEST_CASE("The automatic loop voice follows the transport", "[voices]")
+{
+  auto rendered = makeRenderedSample();
+
+  VoicePool voices;
+  voices.prepare(1, 64, 1000, true);
+  voices.setTransportPlaying(false);
+
+  juce::AudioBuffer<float> block(1, 100);
+  voices.render(block, 0, 100, rendered, 0);
+  REQUIRE(voices.getNumActiveVoices() == 0);
+
+  voices.setTransportPlaying(true);
+  voices.render(block, 0, 100, rendered, 0);
+  REQUIRE(voices.getNumActiveVoices() == 1);
+
+  // Stopping releases the loop with the usual fade rather than cutting it
+  voices.setTransportPlaying(false);
+  voices.render(block, 0, 10, rendered, 0);
+  REQUIRE(voices.getNumActiveVoices() == 1);
+
+  for (int i = 0; i < 10; i++) {
+    voices.render(block, 0, 100, rendered, 0);
+  }
+  REQUIRE(voices.getNumActiveVoices() == 0);
+}
+
+TEST_CASE("A stolen voice fades out instead of cutting off", "[voices]")
+{
+  auto rendered = makeRenderedSample();
+
+  VoicePool voices;
+  voices.prepare(1, 64, 1000, true);
+
+  juce::AudioBuffer<float> block(1, 100);
+  voices.render(block, 0, 100, rendered, 0);
+
+  juce::AudioBuffer<float> played(1, 10);
+  played.clear();
+  voices.noteOn(60, 1.0f);
+  voices.render(played, 0, 10, rendered, 0);
+
+  // The new note from its start, and the loop going on from where it was
+  // under the start of its release
+  juce::AudioBuffer<float> restarted(1, 10);
+  juce::AudioBuffer<float> released(1, 10);
+  restarted.clear();
+  released.clear();
+  rendered.addTo(restarted, 0, 0, 10, 0, VoicePool::headroom);
+  rendered.addTo(released, 0, 100, 10, 0, VoicePool::headroom);
+
+  const float releaseStep = (float) (1.0 / (VoicePool::releaseSeconds * 1000));
+
+  for (int i = 0; i < 10; i++) {
+    float expected = restarted.getSample(0, i) + released.getSample(0, i) * (1.0f - releaseStep * (float) i);
+    REQUIRE_THAT(played.getSample(0, i), Catch::Matchers::WithinAbs(expected, 0.0001));
+  }
+}
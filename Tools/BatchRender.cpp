@@ -0,0 +1,299 @@
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "AudioBufferUtils.h"
+#include "GUIParams.h"
+#include "RenderedSample.h"
+#include "SampleLoader.h"
+#include "StereoBiquad.h"
+#include "SubProcessor.h"
+#include "WorkerPool.h"
+
+/**
+ * Renders a folder of samples through the rise and fall chains with the
+ * parameters of a preset, without a plugin host:
+ *
+ *   BatchRender <preset.xml|preset.json> <input folder> <output folder> [bpm]
+ *
+ * XML presets use the plugin state format, JSON presets map parameter ids to
+ * plain values, e.g. {"timeOffset": -200, "riseReverb": 0}.
+ */
+
+/**
+ * Everything one file is rendered with. The stages cache their outputs, so
+ * every file being rendered at the same time needs one of its own.
+ */
+struct RenderContext {
+  juce::AudioProcessorGraph host;
+  GUIParams parameters{host};
+
+  juce::AudioBuffer<float> riseSampleBuffer;
+  juce::AudioBuffer<float> fallSampleBuffer;
+
+  SubProcessor riseProcessor{RISE, riseSampleBuffer, parameters};
+  SubProcessor fallProcessor{FALL, fallSampleBuffer, parameters};
+};
+
+struct FileResult {
+  juce::File file;
+  juce::String error;
+  double milliseconds = 0;
+  int numSamples = 0;
+};
+
+/**
+ * @param parameters
+ * @param preset
+ * @return An error message, empty on success
+ */
+static juce::String applyPreset (GUIParams &parameters, const juce::File &preset) {
+  if (preset.hasFileExtension("json")) {
+    juce::var json;
+    juce::Result result = juce::JSON::parse(preset.loadFileAsString(), json);
+
+    if (result.failed() || json.getDynamicObject() == nullptr) {
+      return "Invalid JSON preset: " + result.getErrorMessage();
+    }
+
+    for (const auto &property: json.getDynamicObject()->getProperties()) {
+      juce::RangedAudioParameter *parameter = parameters.getParameter(property.name.toString());
+
+      if (parameter == nullptr) {
+        return "Unknown parameter " + property.name.toString();
+      }
+
+      parameter->setValueNotifyingHost(parameter->convertTo0to1((float) property.value));
+    }
+
+    return {};
+  }
+
+  std::unique_ptr<juce::XmlElement> xml = juce::parseXML(preset);
+
+  if (xml == nullptr || !xml->hasTagName(parameters.state.getType())) {
+    return "Invalid XML preset, expected a " + parameters.state.getType().toString() + " element";
+  }
+
+  parameters.replaceState(juce::ValueTree::fromXml(*xml));
+
+  return {};
+}
+
+/**
+ * Render one file the way the plugin renders a loaded sample and write the
+ * mix at the preset's time offset, filtered like the plugin's output
+ *
+ * @param context
+ * @param formatManager
+ * @param input
+ * @param output
+ * @param bpm
+ * @param sourceKey Different for every file, it keys the stage caches
+ * @param result
+ */
+static void renderFile (
+  RenderContext &context,
+  juce::AudioFormatManager &formatManager,
+  const juce::File &input,
+  const juce::File &output,
+  double bpm,
+  juce::uint64 sourceKey,
+  FileResult &result
+) {
+  auto reader = SampleLoader::createReader(formatManager, input);
+
+  if (reader == nullptr) {
+    result.error = "Unsupported format";
+    return;
+  }
+
+  const double sampleRate = reader->sampleRate;
+  juce::AudioBuffer<float> sample;
+  result.error = SampleLoader::read(*reader, sample);
+  reader.reset();
+
+  if (result.error.isNotEmpty()) {
+    return;
+  }
+
+  AudioBufferUtils::normalize(sample);
+  AudioBufferUtils::trim(sample);
+
+  context.riseSampleBuffer.makeCopyOf(sample);
+  context.fallSampleBuffer.makeCopyOf(sample);
+
+  GUIParams &parameters = context.parameters;
+  auto impulseResponseId = (int) parameters.getRawParameterValue(IMPULSE_RESPONSE_ID)->load();
+
+  for (SubProcessor *subProcessor: {&context.riseProcessor, &context.fallProcessor}) {
+    subProcessor->prepareToPlay(sampleRate, bpm);
+    subProcessor->prepareReverb(impulseResponseId);
+    subProcessor->process(sourceKey);
+  }
+
+  for (juce::AudioBuffer<float> *subBuffer: {&context.riseSampleBuffer, &context.fallSampleBuffer}) {
+    AudioBufferUtils::trim(*subBuffer);
+    AudioBufferUtils::normalize(*subBuffer);
+  }
+
+  RenderedSample rendered(
+    std::move(context.riseSampleBuffer),
+    std::move(context.fallSampleBuffer),
+    sampleRate
+  );
+
+  juce::AudioBuffer<float> mix;
+  rendered.mixDown((int) parameters.getRawParameterValue(TIME_OFFSET_ID)->load(), mix);
+
+  float cutoff = juce::jmin(
+    parameters.getRawParameterValue(FILTER_CUTOFF_ID)->load(),
+    (float) (sampleRate * 0.49)
+  );
+  float resonance = parameters.getRawParameterValue(FILTER_RESONANCE_ID)->load();
+  bool highPass = (int) parameters.getRawParameterValue(FILTER_TYPE_ID)->load() == 1;
+
+  StereoBiquad::Coefficients coefficients;
+  StereoBiquad::design(highPass, sampleRate, &cutoff, &resonance, 1, &coefficients);
+
+  StereoBiquad filter;
+  filter.setCoefficients(coefficients);
+  filter.process(mix, 0, mix.getNumSamples());
+
+  output.deleteFile();
+
+  juce::WavAudioFormat wav;
+  std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(
+    output.createOutputStream().release(),
+    sampleRate,
+    (unsigned int) mix.getNumChannels(),
+    24,
+    {},
+    0
+  ));
+
+  if (writer == nullptr || !writer->writeFromAudioSampleBuffer(mix, 0, mix.getNumSamples())) {
+    result.error = "Can't write " + output.getFullPathName();
+    return;
+  }
+
+  result.numSamples = mix.getNumSamples();
+}
+
+int main (int argc, char *argv[]) {
+  if (argc < 4) {
+    std::cerr << "Usage: BatchRender <preset.xml|preset.json> <input folder> <output folder> [bpm]" << std::endl;
+    return 2;
+  }
+
+  // The parameter tree and the impulse response cache expect JUCE to be up
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+  const juce::File cwd = juce::File::getCurrentWorkingDirectory();
+  const juce::File preset = cwd.getChildFile(argv[1]);
+  const juce::File inputFolder = cwd.getChildFile(argv[2]);
+  const juce::File outputFolder = cwd.getChildFile(argv[3]);
+  const double bpm = argc > 4 ? juce::String(argv[4]).getDoubleValue() : 120.0;
+
+  if (!preset.existsAsFile() || !inputFolder.isDirectory() || bpm <= 0) {
+    std::cerr << "Need an existing preset, an input folder and a positive bpm" << std::endl;
+    return 2;
+  }
+
+  if (!outputFolder.createDirectory()) {
+    std::cerr << "Can't create " << outputFolder.getFullPathName() << std::endl;
+    return 1;
+  }
+
+  juce::AudioFormatManager formatManager;
+  formatManager.registerBasicFormats();
+
+  juce::Array<juce::File> files = inputFolder.findChildFiles(
+    juce::File::findFiles,
+    false,
+    formatManager.getWildcardForAllFormats()
+  );
+  files.sort();
+
+  // One context for every thread that can work on a file at the same time,
+  // the calling thread included
+  WorkerPool workers;
+  std::vector<std::unique_ptr<RenderContext>> contexts;
+  std::vector<RenderContext *> idleContexts;
+  juce::CriticalSection contextLock;
+
+  for (int i = 0; i < juce::jmin(files.size(), workers.getNumThreads() + 1); i++) {
+    contexts.push_back(std::make_unique<RenderContext>());
+    idleContexts.push_back(contexts.back().get());
+
+    juce::String error = applyPreset(contexts.back()->parameters, preset);
+
+    if (error.isNotEmpty()) {
+      std::cerr << error << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<FileResult> results((size_t) files.size());
+  juce::CriticalSection reportLock;
+  int numDone = 0;
+
+  const double batchStart = juce::Time::getMillisecondCounterHiRes();
+
+  workers.parallelFor(files.size(), [&] (int index) {
+    RenderContext *context;
+    {
+      const juce::ScopedLock scope(contextLock);
+      context = idleContexts.back();
+      idleContexts.pop_back();
+    }
+
+    FileResult &result = results[(size_t) index];
+    result.file = files[index];
+
+    const double start = juce::Time::getMillisecondCounterHiRes();
+    renderFile(
+      *context,
+      formatManager,
+      result.file,
+      outputFolder.getChildFile(result.file.getFileNameWithoutExtension() + "-rise-and-fall.wav"),
+      bpm,
+      (juce::uint64) index + 1,
+      result
+    );
+    result.milliseconds = juce::Time::getMillisecondCounterHiRes() - start;
+
+    {
+      const juce::ScopedLock scope(contextLock);
+      idleContexts.push_back(context);
+    }
+
+    const juce::ScopedLock scope(reportLock);
+    std::cout << "[" << ++numDone << "/" << files.size() << "] "
+              << result.file.getFileName() << ": "
+              << (result.error.isEmpty() ? juce::String(result.milliseconds, 1) + " ms" : result.error)
+              << std::endl;
+  });
+
+  const double batchMilliseconds = juce::Time::getMillisecondCounterHiRes() - batchStart;
+
+  double totalMilliseconds = 0;
+  int numFailed = 0;
+
+  for (const FileResult &result: results) {
+    totalMilliseconds += result.milliseconds;
+    numFailed += result.error.isNotEmpty() ? 1 : 0;
+  }
+
+  std::cout << files.size() - numFailed << " of " << files.size() << " files rendered in "
+            << juce::String(batchMilliseconds / 1000.0, 2) << " s, "
+            << juce::String(totalMilliseconds / 1000.0, 2) << " s of work on "
+            << contexts.size() << " threads" << std::endl;
+
+  return numFailed > 0 ? 1 : 0;
+}
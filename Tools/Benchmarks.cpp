@@ -0,0 +1,369 @@
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "AudioBufferUtils.h"
+#include "GUIParams.h"
+#include "PluginProcessor.h"
+#include "RenderedSample.h"
+#include "SubProcessor.h"
+
+/**
+ * Throughput of the render stages, the buffer utilities and the playback
+ * path, in samples per channel per second:
+ *
+ *   Benchmarks [--filter <text>] [--save <baseline.json>]
+ *              [--compare <baseline.json>] [--tolerance <fraction>]
+ *
+ * Every case runs until it has been timed for minSeconds and reports its
+ * fastest run, which is the least disturbed by the rest of the system.
+ * The render stage cases leave out the copy of the output into the stage
+ * cache that ends every stage.
+ * Comparing against a baseline exits with 1 when any case got slower than
+ * the tolerance allows.
+ */
+
+static constexpr double minSeconds = 0.3;
+static constexpr int minRuns = 3;
+static constexpr int maxRuns = 1000;
+static constexpr double sampleRate = 48000;
+
+struct Benchmark {
+  juce::String name;
+
+  /**
+   * Samples per channel processed by one run
+   */
+  int numSamples;
+
+  /**
+   * Untimed preparation before every run
+   */
+  std::function<void ()> setup;
+
+  std::function<void ()> run;
+
+  /**
+   * Timed after every run and subtracted from it, for work the run can't
+   * leave out but that isn't what the case measures. Optional.
+   */
+  std::function<void ()> overhead;
+};
+
+/**
+ * @param benchmark
+ * @return Samples per channel per second of the fastest run, less the
+ *         fastest overhead unless that is most of the run
+ */
+static double measure (const Benchmark &benchmark) {
+  double fastest = std::numeric_limits<double>::max();
+  double fastestOverhead = benchmark.overhead ? std::numeric_limits<double>::max() : 0;
+  double total = 0;
+
+  for (int runs = 0; runs < maxRuns && (runs < minRuns || total < minSeconds); runs++) {
+    benchmark.setup();
+
+    const double start = juce::Time::getMillisecondCounterHiRes();
+    benchmark.run();
+    const double seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+
+    fastest = juce::jmin(fastest, seconds);
+    total += seconds;
+
+    // Timed on its own, so the least disturbed overhead is subtracted from
+    // the least disturbed run rather than one noisy timing from another
+    if (benchmark.overhead) {
+      const double overheadStart = juce::Time::getMillisecondCounterHiRes();
+      benchmark.overhead();
+      fastestOverhead = juce::jmin(fastestOverhead, (juce::Time::getMillisecondCounterHiRes() - overheadStart) / 1000.0);
+    }
+  }
+
+  double seconds = fastest - fastestOverhead;
+
+  // An overhead too close to the run to tell them apart, the run is
+  // reported whole rather than as a near infinite throughput
+  if (seconds <= fastest * 0.05) {
+    std::cerr << benchmark.name << ": the overhead is most of the run, not subtracted" << std::endl;
+    seconds = fastest;
+  }
+
+  return benchmark.numSamples / juce::jmax(seconds, 1e-9);
+}
+
+/**
+ * A test signal with some silence at both ends for trim to remove
+ */
+static juce::AudioBuffer<float> makeSignal (int numChannels, int numSamples) {
+  juce::AudioBuffer<float> signal(numChannels, numSamples);
+  juce::Random random(numSamples);
+  int silence = numSamples / 10;
+
+  signal.clear();
+  for (int channel = 0; channel < numChannels; channel++) {
+    for (int i = silence; i < numSamples - silence; i++) {
+      signal.setSample(channel, i, std::sin((float) i * 0.01f) * 0.5f + (random.nextFloat() - 0.5f) * 0.1f);
+    }
+  }
+
+  return signal;
+}
+
+static void setParameter (GUIParams &parameters, const juce::String &id, float value) {
+  juce::RangedAudioParameter *parameter = parameters.getParameter(id);
+  parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+/**
+ * One rise chain with its own parameters, set up to run a single stage
+ */
+struct StageContext {
+  juce::AudioProcessorGraph host;
+  GUIParams parameters{host};
+  juce::AudioBuffer<float> buffer;
+  SubProcessor subProcessor{RISE, buffer, parameters};
+  juce::AudioBuffer<float> source;
+  juce::AudioBuffer<float> storeCopy;
+  juce::uint64 sourceKey = 0;
+  int impulseResponseId = 0;
+
+  StageContext (int numChannels, int numSamples) :
+    source(makeSignal(numChannels, numSamples)) {
+    for (auto id: {RISE_REVERSE_ID, RISE_REVERB_ID, RISE_DELAY_ID}) {
+      setParameter(this->parameters, id, 0);
+    }
+    setParameter(this->parameters, RISE_TIME_WARP_ID, 0);
+  }
+
+  void setup () {
+    this->buffer.makeCopyOf(this->source);
+    this->subProcessor.prepareToPlay(sampleRate, 120);
+    this->subProcessor.prepareReverb(this->impulseResponseId);
+  }
+
+  void run () {
+    // A new key every run, the stage caches would skip the work otherwise
+    this->subProcessor.process(++this->sourceKey);
+  }
+
+  /**
+   * What the stage cache does with the output at the end of every run, a
+   * copy into a buffer already allocated by the previous runs
+   */
+  void storeInCache () {
+    this->storeCopy.makeCopyOf(this->buffer);
+  }
+};
+
+static void addStageBenchmarks (
+  std::vector<Benchmark> &benchmarks,
+  int numChannels,
+  int numSamples
+) {
+  juce::String size = juce::String(numChannels) + "ch " + juce::String(numSamples / sampleRate, 0) + "s";
+
+  auto addStage = [&] (const juce::String &name, const std::function<void (StageContext &)> &configure) {
+    auto context = std::make_shared<StageContext>(numChannels, numSamples);
+    configure(*context);
+
+    benchmarks.push_back({
+      name + " " + size,
+      numSamples,
+      [context] () { context->setup(); },
+      [context] () { context->run(); },
+      [context] () { context->storeInCache(); }
+    });
+  };
+
+  for (int factor: {-2, 2}) {
+    addStage("timeWarp x" + juce::String(factor), [factor] (StageContext &context) {
+      setParameter(context.parameters, RISE_TIME_WARP_ID, (float) factor);
+    });
+  }
+
+  juce::AudioProcessorGraph host;
+  GUIParams parameters(host);
+  juce::StringArray impulseResponseNames =
+    dynamic_cast<juce::AudioParameterChoice *>(parameters.getParameter(IMPULSE_RESPONSE_ID))->choices;
+
+  for (int id = 0; id < impulseResponseNames.size(); id++) {
+    addStage("reverb " + impulseResponseNames[id], [id] (StageContext &context) {
+      setParameter(context.parameters, RISE_REVERB_ID, 1);
+      setParameter(context.parameters, REVERB_MIX_ID, 50);
+      context.impulseResponseId = id;
+    });
+  }
+
+  for (float feedback: {0.0f, 50.0f, 90.0f}) {
+    addStage("delay feedback " + juce::String((int) feedback) + "%", [feedback] (StageContext &context) {
+      setParameter(context.parameters, RISE_DELAY_ID, 1);
+      setParameter(context.parameters, DELAY_MIX_ID, 50);
+      setParameter(context.parameters, DELAY_FEEDBACK_ID, feedback);
+    });
+  }
+
+  auto source = std::make_shared<juce::AudioBuffer<float>>(makeSignal(numChannels, numSamples));
+  auto buffer = std::make_shared<juce::AudioBuffer<float>>();
+
+  benchmarks.push_back({
+    "trim " + size,
+    numSamples,
+    [source, buffer] () { buffer->makeCopyOf(*source); },
+    [buffer] () { AudioBufferUtils::trim(*buffer); },
+    nullptr
+  });
+
+  benchmarks.push_back({
+    "normalize " + size,
+    numSamples,
+    [source, buffer] () { buffer->makeCopyOf(*source); },
+    [buffer] () { AudioBufferUtils::normalize(*buffer); },
+    nullptr
+  });
+
+  // The rise and the fall used to be concatenated into one buffer, this is
+  // the mix that replaced it
+  auto rendered = std::make_shared<RenderedSample>(
+    makeSignal(numChannels, numSamples),
+    makeSignal(numChannels, numSamples),
+    sampleRate
+  );
+
+  benchmarks.push_back({
+    "mixDown " + size,
+    rendered->getNumSamples(-200),
+    [] () {},
+    [rendered, buffer] () { rendered->mixDown(-200, *buffer); },
+    nullptr
+  });
+}
+
+static void addPlaybackBenchmarks (std::vector<Benchmark> &benchmarks) {
+  auto processor = std::make_shared<PluginProcessor>();
+
+  processor->setRateAndBufferSizeDetails(sampleRate, 512);
+  processor->prepareToPlay(sampleRate, 512);
+
+  juce::AudioBuffer<float> sample = makeSignal(2, (int) sampleRate * 2);
+  processor->newSampleLoaded(sample);
+
+  // The render thread publishes the render before the length the editor
+  // reads, so a length means the voices have something to play
+  for (int waited = 0; processor->getNumSamples() <= 0; waited += 10) {
+    if (waited > 60000) {
+      std::cerr << "The render did not finish, skipping processBlock" << std::endl;
+      return;
+    }
+
+    juce::Thread::sleep(10);
+  }
+
+  for (int blockSize: {64, 512}) {
+    auto buffer = std::make_shared<juce::AudioBuffer<float>>(2, blockSize);
+    auto midi = std::make_shared<juce::MidiBuffer>();
+    int numBlocks = (int) sampleRate / blockSize;
+
+    benchmarks.push_back({
+      "processBlock " + juce::String(blockSize) + " samples",
+      numBlocks * blockSize,
+      [] () {},
+      [processor, buffer, midi, numBlocks] () {
+        for (int block = 0; block < numBlocks; block++) {
+          processor->processBlock(*buffer, *midi);
+        }
+      },
+      nullptr
+    });
+  }
+}
+
+int main (int argc, char *argv[]) {
+  juce::StringArray arguments;
+  for (int i = 1; i < argc; i++) {
+    arguments.add(argv[i]);
+  }
+
+  auto option = [&arguments] (const juce::String &name) {
+    int index = arguments.indexOf(name);
+    return index >= 0 && index + 1 < arguments.size() ? arguments[index + 1] : juce::String();
+  };
+
+  const juce::String filter = option("--filter");
+  const juce::String savePath = option("--save");
+  const juce::String comparePath = option("--compare");
+  const double tolerance = option("--tolerance").isEmpty() ? 0.1 : option("--tolerance").getDoubleValue();
+
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+  const juce::File cwd = juce::File::getCurrentWorkingDirectory();
+  juce::var baseline;
+
+  if (comparePath.isNotEmpty()) {
+    juce::Result result = juce::JSON::parse(cwd.getChildFile(comparePath).loadFileAsString(), baseline);
+
+    if (result.failed() || baseline.getDynamicObject() == nullptr) {
+      std::cerr << "Can't read the baseline " << comparePath << std::endl;
+      return 2;
+    }
+  }
+
+  std::vector<Benchmark> benchmarks;
+
+  for (int numChannels: {1, 2}) {
+    for (int seconds: {1, 10}) {
+      addStageBenchmarks(benchmarks, numChannels, (int) sampleRate * seconds);
+    }
+  }
+
+  if (
+    filter.isEmpty() ||
+    filter.containsIgnoreCase("processBlock") ||
+    juce::String("processBlock").containsIgnoreCase(filter)
+    ) {
+    addPlaybackBenchmarks(benchmarks);
+  }
+
+  juce::DynamicObject::Ptr results = new juce::DynamicObject();
+  int numSlower = 0;
+
+  for (const Benchmark &benchmark: benchmarks) {
+    if (filter.isNotEmpty() && !benchmark.name.containsIgnoreCase(filter)) {
+      continue;
+    }
+
+    double samplesPerSecond = measure(benchmark);
+    results->setProperty(benchmark.name, samplesPerSecond);
+
+    std::cout << benchmark.name.paddedRight(' ', 48) << " "
+              << juce::String(samplesPerSecond / 1e6, 2).paddedLeft(' ', 10) << " M samples/s";
+
+    if (baseline.hasProperty(benchmark.name)) {
+      double ratio = samplesPerSecond / (double) baseline[benchmark.name.toRawUTF8()];
+      std::cout << "  " << (ratio >= 1 ? "+" : "") << juce::String((ratio - 1) * 100, 1) << "%";
+
+      if (ratio < 1 - tolerance) {
+        std::cout << "  SLOWER";
+        numSlower++;
+      }
+    }
+
+    std::cout << std::endl;
+  }
+
+  if (savePath.isNotEmpty()) {
+    juce::var json(results.get());
+
+    if (!cwd.getChildFile(savePath).replaceWithText(juce::JSON::toString(json))) {
+      std::cerr << "Can't write the baseline " << savePath << std::endl;
+      return 2;
+    }
+  }
+
+  return numSlower > 0 ? 1 : 0;
+}